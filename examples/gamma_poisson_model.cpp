@@ -71,12 +71,20 @@ int main() {
 
     double alpha__sum{0}, beta__sum{0};
 
-    for (size_t it = 0; it < nb_it; it++) {
-
-        scaling_move(alpha__(m), simple_logprob(lambda_(m)), 1.0, 1, gen);
-        scaling_move(beta__(m), simple_logprob(lambda_(m)), 1.0, 1, gen);
+    auto scheduler = make_scheduler(gen);
+    scheduler.add("alpha", [&m, lp = simple_logprob<shape>(lambda_(m))](auto& gen) {
+        scaling_move(alpha__(m), lp, 1.0, 1, gen);
+    });
+    scheduler.add("beta", [&m, lp = simple_logprob<rate>(lambda_(m))](auto& gen) {
+        scaling_move(beta__(m), lp, 1.0, 1, gen);
+    });
+    scheduler.add("lambda", [&m, lp = observed_matrix_row_logprob(K_(m))](auto& gen) {
+        scaling_move(lambda_(m), lp, 1.0, 1, gen);
+    });
+    scheduler.enable_timing();
 
-        scaling_move(lambda_(m), matrix_row_logprob(K_(m)), 1.0, 1, gen);
+    for (size_t it = 0; it < nb_it; it++) {
+        scheduler.run(1, gen);
 
         alpha__sum += raw_value(alpha__(m));
         beta__sum += raw_value(beta__(m));
@@ -86,4 +94,5 @@ int main() {
               << "alpha_bkp = " << bkp_alpha << "\n"
               << "beta_ = " << beta__sum / float(nb_it) << "\n"
               << "beta_bkp = " << bkp_beta << "\n";
+    scheduler.print_timings(std::cout);
 }
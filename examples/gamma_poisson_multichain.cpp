@@ -0,0 +1,110 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#include <array>
+#include <iostream>
+#include "bayes_toolbox.hpp"
+using namespace std;
+
+TOKEN(alpha_)
+TOKEN(beta_)
+TOKEN(lambda)
+TOKEN(K)
+
+auto poisson_gamma(size_t size, size_t size2) {
+    auto alpha_ = make_node<exponential>(1.0);
+    auto beta_ = make_node<exponential>(1.0);
+    auto lambda = make_node_array<gamma_sr>(size, n_to_one(alpha_), n_to_one(beta_));
+    auto K = make_node_matrix<poisson>(size, size2,
+                                       [& v = get<value>(lambda)](int i, int) { return v[i]; });
+    // clang-format off
+    return make_model(
+        alpha__ = move(alpha_),
+         beta__ = move(beta_),
+        lambda_ = move(lambda),
+             K_ = move(K)
+    );  // clang-format on
+}
+
+int main() {
+    // fixed seeds, so that the run (and its convergence) is reproducible
+    constexpr int seed{42};
+    auto gen = make_generator(seed);
+
+    constexpr size_t nb_chains{4}, len_lambda{50}, len_K{10};
+
+    // simulate observations
+    auto sim = poisson_gamma(len_lambda, len_K);
+    raw_value(alpha__(sim)) = 2.0;
+    raw_value(beta__(sim)) = 1.0;
+    auto v = make_collection(lambda_(sim), K_(sim));
+    draw(v, gen);
+    auto observed_K = get<K, value>(sim);
+
+    // one model per chain, each with its own random initialization
+    auto chains = make_model_array(nb_chains, [&](size_t) {
+        auto m = poisson_gamma(len_lambda, len_K);
+        auto params = make_collection(alpha__(m), beta__(m), lambda_(m));
+        draw(params, gen);
+        set_value(K_(m), observed_K);
+        return m;
+    });
+
+    auto sweep = [](auto& m, auto& gen) {
+        for (double tuning : {1.0, 0.3, 0.1}) {
+            scaling_move(alpha__(m), simple_logprob<shape>(lambda_(m)), tuning, 3, gen);
+            scaling_move(beta__(m), simple_logprob<rate>(lambda_(m)), tuning, 3, gen);
+        }
+        for (double tuning : {1.0, 0.3}) {
+            scaling_move(lambda_(m), observed_matrix_row_logprob(K_(m)), tuning, 1, gen);
+        }
+    };
+    auto observe = [](auto& m) {
+        return std::array<double, 2>{{raw_value(alpha__(m)), raw_value(beta__(m))}};
+    };
+
+    MultiChainSettings settings;
+    settings.seed = seed;
+    settings.max_iterations = 50000;
+    auto result = run_chains(*chains, sweep, observe, settings);
+
+    if (result.converged) {
+        std::cout << "converged after " << result.iterations << " iterations per chain\n";
+    } else {
+        std::cout << "NOT converged after " << result.iterations
+                  << " iterations per chain (max_rhat = " << settings.max_rhat
+                  << ", min_ess = " << settings.min_ess << "), estimates are unreliable\n";
+    }
+    std::cout << "alpha_MCMC = " << result.diagnostics[0].mean
+              << " (rhat = " << result.diagnostics[0].rhat
+              << ", ess = " << result.diagnostics[0].ess_bulk << ")\n"
+              << "alpha_sim = " << get<alpha_, value>(sim) << "\n"
+              << "beta_MCMC = " << result.diagnostics[1].mean
+              << " (rhat = " << result.diagnostics[1].rhat
+              << ", ess = " << result.diagnostics[1].ess_bulk << ")\n"
+              << "beta_sim = " << get<beta_, value>(sim) << "\n";
+}
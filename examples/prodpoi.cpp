@@ -38,15 +38,9 @@ auto poisson_product(size_t n1, size_t n2) {
     auto lambda1 = make_node_array<gamma_ss>(n1, n_to_const(1.0), n_to_const(1.0));
     auto lambda2 = make_node_array<gamma_ss>(n2, n_to_const(1.0), n_to_const(1.0));
 
-    auto mrate = make_dnode_matrix<product>(
-            n1, n2, 
-            [&l1 = get<value>(lambda1)] (int i, int) { return l1[i]; },
-            [&l2 = get<value>(lambda2)] (int, int j) { return l2[j]; });
+    auto mrate = make_dnode_matrix<product>(n1, n2, mn_to_m(lambda1), mn_to_n(lambda2));
 
-    auto K = make_node_matrix<poisson>(
-            n1, n2,
-            [&r = get<value>(mrate)] (int i, int j) { return r[i][j]; }
-        );
+    auto K = make_node_matrix<poisson>(n1, n2, mn_to_mn(mrate));
 
     // clang-format off
     return make_model(
@@ -86,8 +80,9 @@ int main() {
     // size_t nb_it = 100000;
     for (size_t it = 0; it < nb_it; it++) {
 
-        scaling_move(lambda1_(m), matrix_row_logprob(K_(m)), 1.0, 1, gen, matrix_row_gather(mrate_(m)));
-        scaling_move(lambda2_(m), matrix_column_logprob(K_(m)), 1.0, 1, gen, matrix_column_gather(mrate_(m)));
+        // blankets derived from the param bindings: row (resp. column) of mrate and K
+        scaling_move(lambda1_(m), blanket_logprob(m, lambda1_(m)), 1.0, 1, gen, blanket_gather(m, lambda1_(m)));
+        scaling_move(lambda2_(m), blanket_logprob(m, lambda2_(m)), 1.0, 1, gen, blanket_gather(m, lambda2_(m)));
 
         cerr << "=======\n";
         for (size_t i=0; i<n1; i++) {
@@ -3,6 +3,8 @@
 // Structure
 #include "structure/array_utils.hpp"
 #include "structure/model.hpp"
+#include "structure/clone.hpp"
+#include "utils/mapped_file.hpp"
 #include "structure/new_view.hpp"
 
 // Operations
@@ -12,6 +14,7 @@
 #include "operations/backup.hpp"
 
 #include "operations/gather.hpp"
+#include "operations/markov_blanket.hpp"
 #include "operations/raw_value.hpp"
 #include "operations/set_value.hpp"
 
@@ -33,6 +36,12 @@
 #include "moves/proposals.hpp"
 #include "moves/mh.hpp"
 #include "moves/gibbs.hpp"
+#include "moves/elliptical_slice.hpp"
+#include "moves/scheduler.hpp"
+
+// Inference
+#include "inference/multi_chain.hpp"
+#include "inference/smc.hpp"
 
 // Utils
 #include "mcmc_utils.hpp"
@@ -27,6 +27,7 @@ license and that you accept its terms.*/
 #pragma once
 
 #include <cstdlib>
+#include <type_traits>
 #include <vector>
 
 using real = double;
@@ -34,6 +35,18 @@ using pos_real = double;
 using spos_real = double;
 using unit_real = double;
 
+// precision policies for the storage of node values (see make_node_array_with_precision); logprob
+// sums are accumulated in double whatever the policy
+struct double_precision {
+    template <class T>
+    using storage = T;
+};
+
+struct single_precision {
+    template <class T>
+    using storage = std::conditional_t<std::is_floating_point<T>::value, float, T>;
+};
+
 using integer = int;
 using pos_integer = size_t;
 using spos_integer = size_t;
@@ -26,6 +26,9 @@ license and that you accept its terms.*/
 
 #pragma once
 
+#include <functional>
+#include "structure/dnode.hpp"
+
 template<class ValType>
 struct custom_dnode {
     using T = ValType;
@@ -38,3 +41,62 @@ struct custom_dnode {
         // x = f();
     }
 };
+
+//==================================================================================================
+// callable bound to the indices of the element being gathered
+template <class F, size_t NbIndices>
+struct bound_callable;
+
+template <class F>
+struct bound_callable<F, 0> {
+    const F& f;
+    template <class T>
+    void operator()(T& x) const { f(x); }
+};
+
+template <class F>
+struct bound_callable<F, 1> {
+    const F& f;
+    size_t i;
+    template <class T>
+    void operator()(T& x) const { f(x, i); }
+};
+
+template <class F>
+struct bound_callable<F, 2> {
+    const F& f;
+    size_t i, j;
+    template <class T>
+    void operator()(T& x) const { f(x, i, j); }
+};
+
+// custom_dnode templated on the callable type (no std::function indirection nor heap-allocated
+// captures), so that gathers can be inlined
+template <class ValType, class F, size_t NbIndices = 0>
+struct typed_custom_dnode {
+    using T = ValType;
+    using param_decl = param_decl_t<param<lambda_arg, bound_callable<F, NbIndices>>>;
+
+    static void gather(T& x, const bound_callable<F, NbIndices>& f) { f(x); }
+};
+
+// f(x)
+template <class ValType, class F>
+auto make_custom_dnode(F f) {
+    return make_dnode<typed_custom_dnode<ValType, F>>(
+        [f]() { return bound_callable<F, 0>{f}; });
+}
+
+// f(x, i)
+template <class ValType, class F>
+auto make_custom_dnode_array(size_t size, F f) {
+    return make_dnode_array<typed_custom_dnode<ValType, F, 1>>(
+        size, [f](size_t i) { return bound_callable<F, 1>{f, i}; });
+}
+
+// f(x, i, j)
+template <class ValType, class F>
+auto make_custom_dnode_matrix(size_t size_x, size_t size_y, F f) {
+    return make_dnode_matrix<typed_custom_dnode<ValType, F, 2>>(
+        size_x, size_y, [f](size_t i, size_t j) { return bound_callable<F, 2>{f, i, j}; });
+}
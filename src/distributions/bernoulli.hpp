@@ -36,9 +36,12 @@ struct bernoulli {
 
     template <typename Gen>
     static void draw(T& x, unit_real pi, Gen& gen) {
-        std::vector<double> w = {1 - pi, pi};
-        std::discrete_distribution<T> distrib(w.begin(), w.end());
-        x = distrib(gen);
+        x = draw_bernoulli(pi, gen);
+    }
+
+    template <class Prob, typename Gen>
+    static void array_draw(std::vector<T>& x, Prob pi, Gen& gen) {
+        for (size_t i = 0; i < x.size(); i++) { x[i] = draw_bernoulli(pi(i), gen); }
     }
 
     static double logprob(T x, unit_real prob) { return x ? log(prob) : log(1.0 - prob); }
@@ -36,11 +36,18 @@ struct beta_ss {
 
     template <typename Gen>
     static void draw(T& x, spos_real weight_a, spos_real weight_b, Gen& gen) {
-        std::gamma_distribution<double> distriba(positive_real(weight_a), 1.0);
-        std::gamma_distribution<double> distribb(positive_real(weight_b), 1.0);
-        auto aa = distriba(gen);
-        auto bb = distribb(gen);
-        x = {aa / (aa + bb)};
+        x = {BetaSampler(positive_real(weight_a), positive_real(weight_b))(gen)};
+    }
+
+    template <class WeightA, class WeightB, typename Gen>
+    static void array_draw(std::vector<T>& x, WeightA weight_a, WeightB weight_b, Gen& gen) {
+        if (x.empty()) { return; }
+        BetaSampler sampler(positive_real(weight_a(0)), positive_real(weight_b(0)));
+        for (size_t i = 0; i < x.size(); i++) {
+            double a = positive_real(weight_a(i)), b = positive_real(weight_b(i));
+            if (a != sampler.weight_a() || b != sampler.weight_b()) { sampler = BetaSampler(a, b); }
+            x[i] = {sampler(gen)};
+        }
     }
 
     static real logprob(T x, spos_real alpha, spos_real beta) {
@@ -50,11 +57,7 @@ struct beta_ss {
 
     template <class SS, typename Gen>
     static void gibbs_resample(T& x, SS& ss, spos_real weight_a, spos_real weight_b, Gen& gen)  {
-        std::gamma_distribution<double> distriba(positive_real(weight_a) + ss, 1.0);
-        std::gamma_distribution<double> distribb(positive_real(weight_b) + ss, 1.0);
-        auto aa = distriba(gen);
-        auto bb = distribb(gen);
-        x = {aa / (aa + bb)};
+        x = {BetaSampler(positive_real(weight_a) + ss, positive_real(weight_b) + ss)(gen)};
     }
 
 };
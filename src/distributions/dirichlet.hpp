@@ -26,14 +26,21 @@ license and that you accept its terms.*/
 
 #pragma once
 
+#include <array>
+#include <vector>
 #include "gamma.hpp"
+#include "structure/ragged.hpp"
 
-struct dirichlet {
-    using T = std::vector<double>;
-    using param_decl = param_decl_t<param<concentration, std::vector<double>>>;
+// Profile is either std::vector<double>, whose dimension is that of the values, or
+// std::array<double, N>, whose dimension is checked at compile time and whose values are stored
+// inline (see fixed_dirichlet), or a row of a ragged array (see ragged_dirichlet)
+template <class Profile, class Concentration = Profile>
+struct basic_dirichlet {
+    using T = Profile;
+    using param_decl = param_decl_t<param<concentration, Concentration>>;
 
     template <typename Gen>
-    static void draw(T& x, const std::vector<double>& alpha, Gen& gen) {
+    static void draw(T& x, const Concentration& alpha, Gen& gen) {
         size_t k = x.size();
         assert(k == alpha.size());
         double sum_y{0};
@@ -44,9 +51,9 @@ struct dirichlet {
         for (size_t i = 0; i < k; i++) { x[i] /= sum_y; }
     }
 
-    static double logprob(T& x, const std::vector<double>& alpha) {
+    static double logprob(T& x, const Concentration& alpha) {
         size_t k = x.size();
-        assert(k = alpha.size());
+        assert(k == alpha.size());
         double sum_alpha{0}, sum_lgam_alpha{0}, sum_alpha_logx{0};
         for (size_t i = 0; i < k; i++) {
             sum_alpha += alpha[i];
@@ -56,8 +63,37 @@ struct dirichlet {
         return sum_alpha_logx + std::lgamma(sum_alpha) - sum_lgam_alpha;
     }
 
+    // drops the normalizer, which does not depend on x
+    static double partial_logprob_value(T& x, const Concentration& alpha) {
+        assert(x.size() == alpha.size());
+        double sum_alpha_logx{0};
+        for (size_t i = 0; i < x.size(); i++) { sum_alpha_logx += (alpha[i] - 1) * log(x[i]); }
+        return sum_alpha_logx;
+    }
+
+    // normalizer computed once for all the profiles that share alpha (see across_nodes_hoisted);
+    // alpha is copied once per distinct value, and per-profile concentrations are not transformed
+    // at all (see direct_traversal in logprob.hpp)
+    struct transformed_params {
+        Concentration alpha;
+        double log_norm;
+    };
+
+    static transformed_params transform_params(const Concentration& alpha) {
+        double sum_alpha{0}, sum_lgam_alpha{0};
+        for (auto a : alpha) {
+            sum_alpha += a;
+            sum_lgam_alpha += std::lgamma(a);
+        }
+        return {alpha, std::lgamma(sum_alpha) - sum_lgam_alpha};
+    }
+
+    static double transformed_logprob(T& x, const transformed_params& p) {
+        return partial_logprob_value(x, p.alpha) + p.log_norm;
+    }
+
     template <class SS, typename Gen>
-    static void gibbs_resample(T& x, SS& ss, const std::vector<double>& alpha, Gen& gen)  {
+    static void gibbs_resample(T& x, SS& ss, const Concentration& alpha, Gen& gen)  {
         size_t k = x.size();
         assert(k == alpha.size());
         assert(k == ss.size());
@@ -70,12 +106,13 @@ struct dirichlet {
     }
 };
 
-struct dirichlet_cic {
-    using T = std::vector<double>;
-    using param_decl = param_decl_t<param<center, std::vector<double>>, param<invconc, double>>;
+template <class Profile, class Concentration = Profile>
+struct basic_dirichlet_cic {
+    using T = Profile;
+    using param_decl = param_decl_t<param<center, Concentration>, param<invconc, double>>;
 
     template <typename Gen>
-    static void draw(T& x, const std::vector<double>& center, double invconc, Gen& gen) {
+    static void draw(T& x, const Concentration& center, double invconc, Gen& gen) {
         size_t k = x.size();
         assert(k == center.size());
         double sum_y{0};
@@ -86,7 +123,7 @@ struct dirichlet_cic {
         for (size_t i = 0; i < k; i++) { x[i] /= sum_y; }
     }
 
-    static double logprob(T& x, const std::vector<double>& center, double invconc) {
+    static double logprob(T& x, const Concentration& center, double invconc) {
         size_t k = x.size();
         assert(k == center.size());
         double sum_alpha{0}, sum_lgam_alpha{0}, sum_alpha_logx{0};
@@ -98,4 +135,44 @@ struct dirichlet_cic {
         }
         return sum_alpha_logx + std::lgamma(sum_alpha) - sum_lgam_alpha;
     }
+
+    static double partial_logprob_value(T& x, const Concentration& center, double invconc) {
+        assert(x.size() == center.size());
+        double sum_alpha_logx{0};
+        for (size_t i = 0; i < x.size(); i++) {
+            sum_alpha_logx += (center[i] / invconc - 1) * log(x[i]);
+        }
+        return sum_alpha_logx;
+    }
+
+    // concentrations center / invconc and normalizer computed once for all the profiles that
+    // share them
+    using base = basic_dirichlet<Profile, Concentration>;
+
+    static typename base::transformed_params transform_params(const Concentration& center,
+                                                              double invconc) {
+        Concentration alpha = center;
+        for (auto& a : alpha) { a /= invconc; }
+        return base::transform_params(alpha);
+    }
+
+    static double transformed_logprob(T& x, const typename base::transformed_params& p) {
+        return base::transformed_logprob(x, p);
+    }
 };
+
+using dirichlet = basic_dirichlet<std::vector<double>>;
+using dirichlet_cic = basic_dirichlet_cic<std::vector<double>>;
+
+// fixed-size profiles, e.g., fixed_dirichlet<4> for nucleotides or fixed_dirichlet<20> for amino
+// acids; node arrays of these store their profiles contiguously, without one allocation each
+template <size_t N>
+using fixed_dirichlet = basic_dirichlet<std::array<double, N>>;
+
+template <size_t N>
+using fixed_dirichlet_cic = basic_dirichlet_cic<std::array<double, N>>;
+
+// variable-length profiles stored in a single buffer (see make_ragged_node_array), with
+// concentrations given as vectors
+using ragged_dirichlet = basic_dirichlet<RaggedRow<double>, std::vector<double>>;
+using ragged_dirichlet_cic = basic_dirichlet_cic<RaggedRow<double>, std::vector<double>>;
@@ -27,6 +27,7 @@ license and that you accept its terms.*/
 #pragma once
 
 #include "structure/distrib_utils.hpp"
+#include "utils/log_factorial.hpp"
 #include "utils/math_utils.hpp"
 
 struct gamma_ss {
@@ -36,8 +37,18 @@ struct gamma_ss {
 
     template <typename Gen>
     static void draw(T& x, spos_real shape, spos_real scale, Gen& gen) {
-        std::gamma_distribution<double> distrib(positive_real(shape), positive_real(scale));
-        x = {distrib(gen)};
+        x = {GammaSampler(positive_real(shape))(gen) * positive_real(scale)};
+    }
+
+    template <class Shape, class Scale, typename Gen>
+    static void array_draw(std::vector<T>& x, Shape shape, Scale scale, Gen& gen) {
+        if (x.empty()) { return; }
+        GammaSampler sampler(positive_real(shape(0)));
+        for (size_t i = 0; i < x.size(); i++) {
+            double k = positive_real(shape(i));
+            if (k != sampler.shape()) { sampler = GammaSampler(k); }
+            x[i] = {sampler(gen) * positive_real(scale(i))};
+        }
     }
 
     static real logprob(T x, spos_real k, spos_real theta) {
@@ -48,13 +59,26 @@ struct gamma_ss {
         return (k - 1) * log(x) - x / theta;
     }
 
-    static real partial_logprob_param1(T, spos_real k, spos_real theta) {
-        return -std::lgamma(k) - k * log(theta) + (k - 1);
+    static real partial_logprob_param1(T x, spos_real k, spos_real theta) {
+        return -std::lgamma(k) - k * log(theta) + (k - 1) * log(x);
     }
 
     static real partial_logprob_param2(T x, spos_real k, spos_real theta) {
         return -k * log(theta) - x / theta;
     }
+
+    // params transformed once for all the values that share them (see across_nodes_hoisted)
+    struct transformed_params {
+        double k, theta, log_norm;
+    };
+
+    static transformed_params transform_params(spos_real k, spos_real theta) {
+        return {k, theta, -std::lgamma(k) - k * log(theta)};
+    }
+
+    static real transformed_logprob(T x, const transformed_params& p) {
+        return p.log_norm + (p.k - 1) * log(x) - x / p.theta;
+    }
 };
 
 struct gamma_ss_suffstats {
@@ -69,7 +93,7 @@ struct gamma_ss_suffstats {
     }
 
     static double logprob(gamma_ss_suffstats ss, spos_real k, spos_real theta) {
-        return -ss.N * std::lgamma(k) - ss.N * k * log(theta) + (k - 1) * ss.sum_log -
+        return -ss.N * log_gamma(k) - ss.N * k * log(theta) + (k - 1) * ss.sum_log -
                (1 / theta) * ss.sum;
     }
 };
@@ -81,8 +105,18 @@ struct gamma_sr {
 
     template <typename Gen>
     static void draw(T& x, spos_real shape, spos_real rate, Gen& gen) {
-        std::gamma_distribution<double> distrib(positive_real(shape), 1 / positive_real(rate));
-        x = {distrib(gen)};
+        x = {GammaSampler(positive_real(shape))(gen) / positive_real(rate)};
+    }
+
+    template <class Shape, class Rate, typename Gen>
+    static void array_draw(std::vector<T>& x, Shape shape, Rate rate, Gen& gen) {
+        if (x.empty()) { return; }
+        GammaSampler sampler(positive_real(shape(0)));
+        for (size_t i = 0; i < x.size(); i++) {
+            double k = positive_real(shape(i));
+            if (k != sampler.shape()) { sampler = GammaSampler(k); }
+            x[i] = {sampler(gen) / positive_real(rate(i))};
+        }
     }
 
     static real logprob(T x, spos_real alpha, spos_real beta) {
@@ -100,6 +134,18 @@ struct gamma_sr {
     static real partial_logprob_param2(T x, spos_real alpha, spos_real beta) {
         return alpha * log(beta) - beta * x;
     }
+
+    struct transformed_params {
+        double alpha, beta, log_norm;
+    };
+
+    static transformed_params transform_params(spos_real alpha, spos_real beta) {
+        return {alpha, beta, alpha * log(beta) - std::lgamma(alpha)};
+    }
+
+    static real transformed_logprob(T x, const transformed_params& p) {
+        return p.log_norm + (p.alpha - 1) * log(x) - p.beta * x;
+    }
 };
 
 struct gamma_mi {
@@ -109,9 +155,19 @@ struct gamma_mi {
 
     template <typename Gen>
     static void draw(T& x, spos_real mean, spos_real invshape, Gen& gen) {
-        std::gamma_distribution<double> distrib(1. / positive_real(invshape),
-                                                positive_real(mean) * positive_real(invshape));
-        x = {distrib(gen)};
+        x = {GammaSampler(1. / positive_real(invshape))(gen) * positive_real(mean) *
+             positive_real(invshape)};
+    }
+
+    template <class Mean, class InvShape, typename Gen>
+    static void array_draw(std::vector<T>& x, Mean mean, InvShape invshape, Gen& gen) {
+        if (x.empty()) { return; }
+        GammaSampler sampler(1. / positive_real(invshape(0)));
+        for (size_t i = 0; i < x.size(); i++) {
+            double k = 1. / positive_real(invshape(i));
+            if (k != sampler.shape()) { sampler = GammaSampler(k); }
+            x[i] = {sampler(gen) * positive_real(mean(i)) / k};
+        }
     }
 
     static real logprob(const T& x, spos_real mean, spos_real invshape) {
@@ -126,18 +182,14 @@ struct gamma_mi {
         double shape2 = shape1 + ss.count;
         double rate1 = 1.0 / (mean * invshape);
         double rate2 = rate1 + ss.beta;
-        double l1 = shape1 * log(rate1) - std::lgamma(shape1);
-        double l2 = shape2 * log(rate2) - std::lgamma(shape2);
-        return l1 - l2;
+        return shape1 * log(rate1) - shape2 * log(rate2) + log_rising_factorial(shape1, ss.count);
     }
 
     template <class SS, typename Gen>
     static void gibbs_resample(T& x, SS& ss, spos_real mean, spos_real invshape, Gen& gen)  {
         double shape = 1.0 / invshape + ss.count;
         double rate = 1.0 / (mean * invshape) + ss.beta;
-        double scale = 1.0 / rate;
-        std::gamma_distribution<double> distrib(shape, scale);
-        x = {distrib(gen)};
+        x = {GammaSampler(shape)(gen) / rate};
     }
 };
 
@@ -44,4 +44,7 @@ struct normal {
         double y = (x - mean) * (x - mean) / variance;
         return -0.5 * y - log(variance * sqrt(2.0 * constants::pi));
     }
+
+    // prior mean, used by elliptical slice sampling
+    static real center(pos_real mean, spos_real) { return mean; }
 };
@@ -27,10 +27,9 @@ license and that you accept its terms.*/
 #pragma once
 
 #include "structure/distrib_utils.hpp"
+#include "utils/log_factorial.hpp"
 #include "utils/math_utils.hpp"
 
-double log_factorial(int n) { return std::lgamma(n + 1); }
-
 struct poisson {
     using T = pos_integer;
 
@@ -38,8 +37,18 @@ struct poisson {
 
     template <typename Gen>
     static void draw(T& x, spos_real rate, Gen& gen) {
-        std::poisson_distribution<int> distrib(positive_real(rate));
-        x = distrib(gen);
+        x = PoissonSampler(positive_real(rate))(gen);
+    }
+
+    template <class Rate, typename Gen>
+    static void array_draw(std::vector<T>& x, Rate rate, Gen& gen) {
+        if (x.empty()) { return; }
+        PoissonSampler sampler(positive_real(rate(0)));
+        for (size_t i = 0; i < x.size(); i++) {
+            double r = positive_real(rate(i));
+            if (r != sampler.rate()) { sampler = PoissonSampler(r); }
+            x[i] = sampler(gen);
+        }
     }
 
     static real logprob(T x, spos_real lambda) {
@@ -51,6 +60,26 @@ struct poisson {
     }
 
     static real partial_logprob_param1(T x, spos_real lambda) { return x * log(lambda) - lambda; }
+
+    // logprob = param_logprob + data_logprob; the latter is constant for observed counts
+    static real param_logprob(T x, spos_real lambda) { return partial_logprob_param1(x, lambda); }
+
+    static real data_logprob(T x) { return -log_factorial(x); }
+
+    // params transformed once for all the counts that share them (see across_nodes_hoisted)
+    struct transformed_params {
+        double lambda, log_lambda;
+    };
+
+    static transformed_params transform_params(spos_real lambda) { return {lambda, log(lambda)}; }
+
+    static real transformed_logprob(T x, const transformed_params& p) {
+        return x * p.log_lambda - p.lambda - log_factorial(x);
+    }
+
+    static real transformed_param_logprob(T x, const transformed_params& p) {
+        return x * p.log_lambda - p.lambda;
+    }
 };
 
 // struct poisson_suffstat {
@@ -0,0 +1,108 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <assert.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+#include "utils/convergence.hpp"
+#include "utils/random.hpp"
+
+struct MultiChainSettings {
+    size_t burn_in{1000};           // iterations per chain before monitoring starts
+    size_t check_every{1000};       // iterations per chain between two convergence checks
+    size_t max_iterations{100000};  // monitored iterations per chain
+    double max_rhat{1.01};
+    double min_ess{400};  // required for both bulk and tail ESS
+    int seed{int(std::random_device()())};
+};
+
+struct MultiChainResult {
+    bool converged{false};
+    size_t iterations{0};  // monitored iterations per chain
+    std::vector<ConvergenceDiagnostics> diagnostics;  // one per observable
+};
+
+/*==================================================================================================
+~~ Multi-chain runner ~~
+Runs one chain per model, each on its own thread and with its own generator, until all
+observables pass the convergence criteria (or max_iterations is reached).
+  - sweep(model, gen) performs one MCMC iteration on a model; it is copied for each thread
+  - observe(model) returns the scalar observables to monitor as an indexable container (e.g., a
+    std::array<double, N>)
+Chains are synchronized every check_every iterations to compute the diagnostics.
+==================================================================================================*/
+template <class Model, class Sweep, class Observe>
+MultiChainResult run_chains(std::vector<Model>& models, Sweep sweep, Observe observe,
+                            const MultiChainSettings& settings = MultiChainSettings()) {
+    size_t nb_chains = models.size();
+    assert(nb_chains > 1);
+    auto gens = make_streams(nb_chains, settings.seed);
+    ConvergenceMonitor monitor(nb_chains);
+
+    auto run_all = [&](size_t nb_it, bool record) {
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < nb_chains; c++) {
+            threads.emplace_back([&, c, sweep, observe]() mutable {
+                for (size_t it = 0; it < nb_it; it++) {
+                    sweep(models[c], gens[c]);
+                    if (record) { monitor.add(c, observe(models[c])); }
+                }
+            });
+        }
+        for (auto& t : threads) { t.join(); }
+    };
+
+    auto passes = [&settings](const ConvergenceDiagnostics& d) {
+        return d.rhat <= settings.max_rhat && d.ess_bulk >= settings.min_ess &&
+               d.ess_tail >= settings.min_ess;
+    };
+
+    MultiChainResult result;
+    run_all(settings.burn_in, false);
+    while (result.iterations < settings.max_iterations) {
+        size_t nb_it = std::min(settings.check_every, settings.max_iterations - result.iterations);
+        run_all(nb_it, true);
+        result.iterations += nb_it;
+        if (!monitor.tail_thresholds_set()) {
+            monitor.set_tail_thresholds();  // first monitored round calibrates tail thresholds
+            continue;
+        }
+        result.diagnostics = monitor.diagnostics();
+        if (std::all_of(result.diagnostics.begin(), result.diagnostics.end(), passes)) {
+            result.converged = true;
+            break;
+        }
+    }
+    if (result.diagnostics.empty() && result.iterations > 0) {
+        result.diagnostics = monitor.diagnostics();
+    }
+    return result;
+}
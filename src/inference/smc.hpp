@@ -0,0 +1,179 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "mcmc_utils.hpp"
+#include "operations/backup.hpp"
+#include "utils/parallel.hpp"
+#include "utils/random.hpp"
+
+/*==================================================================================================
+~~ Sequential Monte Carlo ~~
+Particles are models (e.g., built with make_model_array or clone_model_array). Resampling copies
+the values of the nodes making up the particle state rather than whole models; state(model) must
+return a collection of these nodes (e.g., make_collection(alpha_(m), lambda_(m))). Observed nodes are
+expected to hold the same values in all particles and are not part of the state.
+Each particle has its own generator so that results do not depend on the number of threads.
+==================================================================================================*/
+template <class Model, class State>
+class SMCSampler {
+    std::vector<Model>& _particles;
+    State _state;
+    std::vector<double> _logw;
+    std::vector<default_engine> _gens;
+    std::vector<size_t> _ancestors, _offspring;  // scratch space for resampling
+    double _log_evidence{0};
+    size_t _nb_threads;
+
+    double log_sum_weights() const {
+        double max = *std::max_element(_logw.begin(), _logw.end());
+        double tot = 0;
+        for (auto w : _logw) { tot += exp(w - max); }
+        return max + log(tot);
+    }
+
+    // systematic resampling; a particle with offspring is its own ancestor, so that copies
+    // only go from surviving particles to discarded ones
+    void draw_ancestors(double u) {
+        size_t n = _particles.size();
+        double lse = log_sum_weights();
+        auto& offspring = _offspring;
+        std::fill(offspring.begin(), offspring.end(), 0);
+        double cumul = 0;
+        size_t j = 0;
+        for (size_t i = 0; i < n; i++) {
+            cumul += exp(_logw[i] - lse) * n;
+            while (j < n && j + u < cumul) {
+                offspring[i]++;
+                j++;
+            }
+        }
+        offspring[n - 1] += n - j;  // guards against rounding errors on the last weight
+        size_t next_free = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (offspring[i] > 0) { _ancestors[i] = i; }
+        }
+        for (size_t i = 0; i < n; i++) {
+            for (size_t k = 1; k < offspring[i]; k++) {
+                while (offspring[next_free] > 0) { next_free++; }
+                _ancestors[next_free++] = i;
+            }
+        }
+    }
+
+  public:
+    SMCSampler(std::vector<Model>& particles, State state, int seed,
+               size_t nb_threads = default_nb_threads())
+        : _particles(particles),
+          _state(state),
+          _logw(particles.size(), 0),
+          _gens(make_streams(particles.size(), seed)),
+          _ancestors(particles.size()),
+          _offspring(particles.size()),
+          _nb_threads(nb_threads) {}
+
+    size_t size() const { return _particles.size(); }
+    double log_evidence() const { return _log_evidence; }
+
+    // applies f(model) to all particles, in parallel (e.g., to set newly observed values)
+    template <class F>
+    void for_each(F f) {
+        parallel_for(size(), _nb_threads, [this, &f](size_t i) { f(_particles[i]); });
+    }
+
+    // multiplies particle weights by exp(incremental_logprob(model)), typically the logprob of
+    // a new batch of observations
+    template <class IncrementalLogProb>
+    void reweight(IncrementalLogProb incremental_logprob) {
+        double before = log_sum_weights();
+        parallel_for(size(), _nb_threads,
+                     [this, &incremental_logprob](size_t i) {
+                         _logw[i] += incremental_logprob(_particles[i]);
+                     });
+        _log_evidence += log_sum_weights() - before;
+    }
+
+    // normalized effective sample size, in (0, 1]
+    double ess() const {
+        double lse = log_sum_weights();
+        double sum_squares = 0;
+        for (auto w : _logw) { sum_squares += exp(2 * (w - lse)); }
+        return 1. / (sum_squares * size());
+    }
+
+    template <class Gen>
+    void resample(Gen& gen) {
+        draw_ancestors(draw_uniform(gen));
+        parallel_for(size(), _nb_threads, [this](size_t i) {
+            if (_ancestors[i] != i) {
+                auto from = _state(_particles[_ancestors[i]]);
+                auto to = _state(_particles[i]);
+                auto values = backup(from);
+                restore(to, values);
+            }
+        });
+        std::fill(_logw.begin(), _logw.end(), 0.);
+    }
+
+    // applies move(model, gen) to all particles in parallel; move should leave the current
+    // posterior invariant (e.g., a few sweeps of MH moves using the data observed so far)
+    template <class Move>
+    void rejuvenate(Move move) {
+        parallel_for(size(), _nb_threads, [this, &move](size_t i) { move(_particles[i], _gens[i]); });
+    }
+
+    // reweight / resample if ESS < ess_threshold / rejuvenate; returns true if resampling occurred
+    template <class IncrementalLogProb, class Move, class Gen>
+    bool update(IncrementalLogProb incremental_logprob, Move move, Gen& gen,
+                double ess_threshold = 0.5) {
+        reweight(incremental_logprob);
+        bool resampled = ess() < ess_threshold;
+        if (resampled) { resample(gen); }
+        rejuvenate(move);
+        return resampled;
+    }
+
+    // normalized-weight average of f(model) across particles
+    template <class F>
+    double weighted_mean(F f) {
+        double lse = log_sum_weights();
+        double result = 0;
+        for (size_t i = 0; i < size(); i++) { result += exp(_logw[i] - lse) * f(_particles[i]); }
+        return result;
+    }
+};
+
+template <class Model, class State>
+auto make_smc_sampler(std::vector<Model>& particles, State state, int seed,
+                      size_t nb_threads = default_nb_threads()) {
+    return SMCSampler<Model, State>(particles, state, seed, nb_threads);
+}
@@ -93,6 +93,45 @@ auto matrix_element_logprob(Node& node)  {
     };
 }
 
+// same as above, restricted to the terms of the node logprob that depend on Role (see
+// partial_logprob), e.g. simple_logprob<shape>(lambda) for a move on the shape of lambda
+template <class Role, class Node>
+auto simple_logprob(Node& node) {
+    return [&node] () {return partial_logprob<Role>(node);};
+}
+
+template <class Role, class Node>
+auto array_element_logprob(Node& node)  {
+    return [&node] (int i) {
+        auto subset = subsets::element(node,i);
+        return partial_logprob<Role>(subset);
+    };
+}
+
+template <class Role, class Node>
+auto matrix_row_logprob(Node& node)  {
+    return [&node] (int i) {
+        auto subset = subsets::row(node,i);
+        return partial_logprob<Role>(subset);
+    };
+}
+
+template <class Role, class Node>
+auto matrix_column_logprob(Node& node)  {
+    return [&node] (int i) {
+        auto subset = subsets::column(node,i);
+        return partial_logprob<Role>(subset);
+    };
+}
+
+template <class Role, class Node>
+auto matrix_element_logprob(Node& node)  {
+    return [&node] (int i, int j) {
+        auto subset = subsets::element(node,i,j);
+        return partial_logprob<Role>(subset);
+    };
+}
+
 template <class Node>
 auto cubix_element_logprob(Node& node)  {
     return [&node] (int i, int j, int k) {
@@ -149,6 +188,48 @@ auto cubix_slice011_logprob(Node& node) {
     };
 }
 
+/*==================================================================================================
+~~ Blankets of observed nodes ~~
+Same as above for nodes whose values are fixed (observed data): the terms of the logprob that only
+depend on the data are left out (see param_logprob), which does not change MH ratios.
+==================================================================================================*/
+template <class Node>
+auto observed_logprob(Node& node) {
+    return [&node] () {return param_logprob(node);};
+}
+
+template <class Node>
+auto observed_array_element_logprob(Node& node)  {
+    return [&node] (int i) {
+        auto subset = subsets::element(node,i);
+        return param_logprob(subset);
+    };
+}
+
+template <class Node>
+auto observed_matrix_row_logprob(Node& node)  {
+    return [&node] (int i) {
+        auto subset = subsets::row(node,i);
+        return param_logprob(subset);
+    };
+}
+
+template <class Node>
+auto observed_matrix_column_logprob(Node& node)  {
+    return [&node] (int i) {
+        auto subset = subsets::column(node,i);
+        return param_logprob(subset);
+    };
+}
+
+template <class Node>
+auto observed_matrix_element_logprob(Node& node)  {
+    return [&node] (int i, int j) {
+        auto subset = subsets::element(node,i,j);
+        return param_logprob(subset);
+    };
+}
+
 template <class Node>
 auto simple_gather(Node& node) {
     return [&node] () {return gather(node);};
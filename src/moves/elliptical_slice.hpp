@@ -0,0 +1,86 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <vector>
+#include "mcmc_utils.hpp"
+#include "moves/mh.hpp"
+#include "operations/across_values.hpp"
+#include "utils/math_utils.hpp"
+
+/*==================================================================================================
+~~ Elliptical slice sampling (Murray, Adams & MacKay, 2010) ~~
+For nodes (lone, arrays, matrices...) with a gaussian prior. All the values of the node are moved
+jointly along an ellipse going through the current value and an auxiliary prior draw (obtained
+with draw()), so only the likelihood blanket lp() is ever evaluated. No tuning, no rejection.
+The distribution must provide center(params...), the mean of the gaussian prior.
+==================================================================================================*/
+template <class Node, class LogProb, class Gen, class Update = NoUpdate>
+void elliptical_slice_move(Node& node, LogProb lp, size_t nrep, Gen& gen, Update update = {}) {
+    std::vector<double> current, centers, aux;
+    for (size_t rep = 0; rep < nrep; rep++) {
+        current.clear();
+        centers.clear();
+        aux.clear();
+        across_values(node, [&current](auto& x) { current.push_back(x); });
+        across_nodes(node, [&centers](auto distrib, auto&, auto... params) {
+            centers.push_back(decltype(distrib)::center(params...));
+        });
+
+        // auxiliary draw from the (centered) prior
+        draw(node, gen);
+        across_values(node, [&aux](auto& x) { aux.push_back(x); });
+        for (size_t k = 0; k < aux.size(); k++) { aux[k] -= centers[k]; }
+
+        auto set_on_ellipse = [&](double angle) {
+            size_t k = 0;
+            double c = cos(angle), s = sin(angle);
+            across_values(node, [&](auto& x) {
+                x = (current[k] - centers[k]) * c + aux[k] * s + centers[k];
+                k++;
+            });
+            update();
+        };
+
+        set_on_ellipse(0);  // back to the current value
+        double log_threshold = lp() + log(draw_uniform(gen));
+        double angle = 2 * constants::pi * draw_uniform(gen);
+        double min = angle - 2 * constants::pi, max = angle;
+        while (true) {
+            set_on_ellipse(angle);
+            if (lp() > log_threshold) { break; }
+            // shrink the bracket towards the current value (angle 0), which is always accepted
+            if (angle < 0) {
+                min = angle;
+            } else {
+                max = angle;
+            }
+            angle = min + (max - min) * draw_uniform(gen);
+        }
+    }
+}
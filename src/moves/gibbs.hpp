@@ -1,4 +1,24 @@
 
+// values stored with another type than Distrib::T (see make_node_array_with_precision) are
+// resampled through a temporary
+template <class Distrib, class X, class... Args>
+static void gibbs_resample_value(std::true_type /* stored as Distrib::T */, X& x, Args&&... args) {
+    Distrib::gibbs_resample(x, std::forward<Args>(args)...);
+}
+
+template <class Distrib, class X, class... Args>
+static void gibbs_resample_value(std::false_type, X& x, Args&&... args) {
+    typename Distrib::T v = x;
+    Distrib::gibbs_resample(v, std::forward<Args>(args)...);
+    x = v;
+}
+
+template <class Distrib, class X, class... Args>
+static void gibbs_resample_value(X& x, Args&&... args) {
+    gibbs_resample_value<Distrib>(std::is_same<X, typename Distrib::T>(), x,
+                                  std::forward<Args>(args)...);
+}
+
 template <class Distrib, class T, class SS, class F, class Params, class... Keys, class... Indexes>
 static void gibbs_unpack_params(Distrib, T& x, SS& ss, F f, const Params& params, std::tuple<Keys...>,
                    Indexes... is) {
@@ -30,7 +50,9 @@ static void gibbs_apply(node_array_tag, Array& a, SS& ss, F f, int i)    {
 
 template <class Node, class SS, class Gen, class... Args>
 static void gibbs_resample(Node& n, SS& ss, Gen& gen, Args... args) {
-    auto gibbs_lambda = [&gen] (auto distrib, auto& x, auto& s, auto... params) { decltype(distrib)::gibbs_resample(x,s,params...,gen); };
+    auto gibbs_lambda = [&gen](auto distrib, auto& x, auto& s, auto... params) {
+        gibbs_resample_value<decltype(distrib)>(x, s, params..., gen);
+    };
     gibbs_apply(type_tag(n), n, ss, gibbs_lambda, args...);
 }
 
@@ -65,6 +87,8 @@ static void gibbs_apply(node_array_tag, Array& a, LogProb logprob, F f, int i)
 
 template <class Node, class LogProb, class Gen, class... Args>
 static void logprob_gibbs_resample(Node& n, LogProb logprob, Gen& gen, Args... args) {
-    auto gibbs_lambda = [&gen] (auto distrib, auto& x, auto s, auto... params) { decltype(distrib)::gibbs_resample(x,s,params...,gen); };
+    auto gibbs_lambda = [&gen](auto distrib, auto& x, auto s, auto... params) {
+        gibbs_resample_value<decltype(distrib)>(x, s, params..., gen);
+    };
     logprob_gibbs_apply(type_tag(n), n, logprob, gibbs_lambda, args...);
 }
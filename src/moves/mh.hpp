@@ -36,16 +36,18 @@ struct NoUpdate {
     void operator()(Index...) {}
 };
 
+// the node's own logprob is restricted to the terms that depend on its value (partial_logprob),
+// the others cancel out in the MH ratio
 struct mh_overloads {
 
     template <class Node, class LogProb, class Proposal, class Gen, class Update = NoUpdate>
     static void mh_move(lone_node_tag, Node& node, LogProb lp, Proposal P, size_t nrep, Gen& gen, Update update = {}) {
         for (size_t rep=0; rep<nrep; rep++) {
             auto bkp = backup(node);
-            double logprob_before = logprob(node) + lp();
+            double logprob_before = partial_logprob<value>(node) + lp();
             double log_hastings = P(get<value>(node), gen);
             update();
-            double logprob_after = logprob(node) + lp();
+            double logprob_after = partial_logprob<value>(node) + lp();
             bool accept = decide(logprob_after - logprob_before + log_hastings, gen);
             if (!accept) {
                 restore(node, bkp);
@@ -60,10 +62,10 @@ struct mh_overloads {
             for (size_t i=0; i<get<value>(node).size(); i++)    {
                 auto subset = subsets::element(node,i);
                 auto bkp = backup(subset);
-                double logprob_before = logprob(subset) + lp(i);
+                double logprob_before = partial_logprob<value>(subset) + lp(i);
                 double log_hastings = P(get<value>(node)[i], gen);
                 update(i);
-                double logprob_after = logprob(subset) + lp(i);
+                double logprob_after = partial_logprob<value>(subset) + lp(i);
                 bool accept = decide(logprob_after - logprob_before + log_hastings, gen);
                 if (!accept) {
                     restore(subset, bkp);
@@ -72,6 +74,47 @@ struct mh_overloads {
             }
         }
     }
+
+    // same as mh_move for vector-valued (profile) nodes, but the backup goes to a reused buffer
+    // instead of a fresh copy of the profile, so that steady-state sweeps do not allocate
+    template <class Node, class LogProb, class Proposal, class Gen, class Update = NoUpdate>
+    static void profile_mh_move(lone_node_tag, Node& node, LogProb lp, Proposal P, size_t nrep, Gen& gen, Update update = {}) {
+        static thread_local std::vector<double> bkp;
+        auto& profile = get<value>(node);
+        for (size_t rep=0; rep<nrep; rep++) {
+            bkp.assign(profile.begin(), profile.end());
+            double logprob_before = partial_logprob<value>(node) + lp();
+            double log_hastings = P(profile, gen);
+            update();
+            double logprob_after = partial_logprob<value>(node) + lp();
+            bool accept = decide(logprob_after - logprob_before + log_hastings, gen);
+            if (!accept) {
+                std::copy(bkp.begin(), bkp.end(), profile.begin());
+                update();
+            }
+        }
+    }
+
+    template <class Node, class LogProb, class Proposal, class Gen, class Update = NoUpdate>
+    static void profile_mh_move(node_array_tag, Node& node, LogProb lp, Proposal P, size_t nrep, Gen& gen, Update update = {}) {
+        static thread_local std::vector<double> bkp;
+        for (size_t rep=0; rep<nrep; rep++) {
+            for (size_t i=0; i<get<value>(node).size(); i++)    {
+                auto subset = subsets::element(node,i);
+                auto& profile = get<value>(node)[i];
+                bkp.assign(profile.begin(), profile.end());
+                double logprob_before = partial_logprob<value>(subset) + lp(i);
+                double log_hastings = P(profile, gen);
+                update(i);
+                double logprob_after = partial_logprob<value>(subset) + lp(i);
+                bool accept = decide(logprob_after - logprob_before + log_hastings, gen);
+                if (!accept) {
+                    std::copy(bkp.begin(), bkp.end(), profile.begin());
+                    update(i);
+                }
+            }
+        }
+    }
 };
 
 template <class Node, class LogProb, class Proposal, class Gen, class... Update>
@@ -98,3 +141,19 @@ void slide_constrained_move(Node& node, LogProb lp, double tuning, double min, d
             gen,
             update...);
 }
+
+// moves on the simplex, for dirichlet (or dirichlet_cic) nodes and node arrays
+template <class Node, class LogProb, class Gen, class... Update>
+void profile_sliding_move(Node& node, LogProb lp, int n, double tuning, size_t nrep, Gen& gen, Update... update) {
+    mh_overloads::profile_mh_move(type_tag(node), node, lp, proposals::profile_sliding(n, tuning), nrep, gen, update...);
+}
+
+template <class Node, class LogProb, class Gen, class... Update>
+void profile_dirichlet_move(Node& node, LogProb lp, double concentration, size_t nrep, Gen& gen, Update... update) {
+    mh_overloads::profile_mh_move(type_tag(node), node, lp, proposals::profile_dirichlet(concentration), nrep, gen, update...);
+}
+
+template <class Node, class LogProb, class Gen, class... Update>
+void profile_scaling_move(Node& node, LogProb lp, int n, double tuning, size_t nrep, Gen& gen, Update... update) {
+    mh_overloads::profile_mh_move(type_tag(node), node, lp, proposals::profile_scaling(n, tuning), nrep, gen, update...);
+}
@@ -26,26 +26,30 @@ license and that you accept its terms.*/
 
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
 #include "mcmc_utils.hpp"
 #include "operations/backup.hpp"
 #include "operations/draw.hpp"
 
-template <typename Gen>
-double scale(double& value, double tuning, Gen& gen)    {
+// Real is double, or float for values stored in single precision (see precision policies)
+template <class Real, typename Gen>
+double scale(Real& value, double tuning, Gen& gen)    {
     auto multiplier = tuning * (draw_uniform(gen) - 0.5);
     value *= exp(multiplier);
     return multiplier;
 }
 
-template <class Gen>
-double slide(double& value, double tuning, Gen& gen)    {
+template <class Real, class Gen>
+double slide(Real& value, double tuning, Gen& gen)    {
     auto slide_amount = tuning * (draw_uniform(gen) - 0.5);
     value += slide_amount;
     return 0.;
 }
 
-template <class Gen>
-double slide_constrained(double& value, double tuning, double min, double max, Gen& gen)    {
+template <class Real, class Gen>
+double slide_constrained(Real& value, double tuning, double min, double max, Gen& gen)    {
     assert(value >= min && value <= max);
     slide(value, tuning, gen);
     while (value < min || value > max) {
@@ -55,8 +59,8 @@ double slide_constrained(double& value, double tuning, double min, double max, G
     return 0.;
 }
 
-template <class Gen>
-double profile_move(std::vector<double>& vec, double tuning, Gen& gen) {
+template <class Profile, class Gen>
+double profile_move(Profile& vec, double tuning, Gen& gen) {
     size_t n = vec.size();
     assert(n > 1);
 
@@ -75,96 +79,96 @@ double profile_move(std::vector<double>& vec, double tuning, Gen& gen) {
     return 0.;  // sliding move
 }
 
-// draw n out of N with replacement
-template<class Gen>
-void draw_with_replacement(std::vector<int>& tab, int N, Gen& gen) {
-    int n = tab.size();
-    std::vector<int> index(N,0);
-    for (int i=0; i<n; i++) {
-        int trial = (int)(draw_uniform(gen) * (N-i));
-        for (int k=0; k<N; k++) {
-            if (index[k] != 0) {
-                if (trial >= k) {
-                    trial++;
-                }
-            }
-        }
-        if (trial == N) {
-            std::cerr << "error in draw from urn: overflow\n";
-            exit(1);
-        }
-        tab[i] = trial;
-        if (index[trial] != 0) {
-            std::cerr << "error in draw from urn: chose twice the same\n";
-            exit(1);
-        }
-        index[trial] = 1;
+// draws n distinct indices in [0, dim) in O(n), without allocation in steady state: partial
+// Fisher-Yates shuffle of a persistent permutation (any permutation is a valid starting point,
+// so it never needs to be reset). Returns a pointer to the n indices.
+template <class Gen>
+const size_t* draw_distinct_indices(size_t n, size_t dim, Gen& gen) {
+    assert(n <= dim);
+    static thread_local std::vector<size_t> permutation;
+    if (permutation.size() != dim) {
+        permutation.resize(dim);
+        std::iota(permutation.begin(), permutation.end(), 0);
     }
+    for (size_t k = 0; k < n; k++) {
+        size_t r = std::uniform_int_distribution<size_t>(k, dim - 1)(gen);
+        std::swap(permutation[k], permutation[r]);
+    }
+    return permutation.data();
 }
 
-template <class Gen>
-double profile_move(std::vector<double>& profile, int n, double tuning, Gen& gen) {
-    int dim = profile.size();
-    double ret = 0;
-    /*
-    if (n == 0) {  // dirichlet
-        double oldprofile[dim];
-        for (int i = 0; i < dim; i++) {
-            oldprofile[i] = profile[i];
-        }
-        double total = 0;
-        for (int i = 0; i < dim; i++) {
-            profile[i] = Random::sGamma(tuning * oldprofile[i]);
-            if (profile[i] == 0) {
-                std::cerr << "error in dirichlet resampling : 0 \n";
-                exit(1);
-            }
-            total += profile[i];
-        }
-        double logHastings = 0;
-        for (int i = 0; i < dim; i++) {
-            profile[i] /= total;
-            logHastings += -Random::logGamma(tuning * oldprofile[i]) +
-                           Random::logGamma(tuning * profile[i]) -
-                           (tuning * profile[i] - 1.0) * log(oldprofile[i]) +
-                           (tuning * oldprofile[i] - 1.0) * log(profile[i]);
+// slides n disjoint pairs of components, keeping the sum of each pair constant (symmetric)
+template <class Profile, class Gen>
+double profile_move(Profile& profile, int n, double tuning, Gen& gen) {
+    size_t dim = profile.size();
+    assert(dim > 1);
+    size_t nb_pairs = std::min(size_t(std::max(n, 1)), dim / 2);
+    const size_t* indices = draw_distinct_indices(2 * nb_pairs, dim, gen);
+    for (size_t p = 0; p < nb_pairs; p++) {
+        double& x1 = profile[indices[2 * p]];
+        double& x2 = profile[indices[2 * p + 1]];
+        double tot = x1 + x2;
+        double x = x1 + tot * tuning * (draw_uniform(gen) - 0.5);
+        while ((x < 0) || (x > tot)) {
+            if (x < 0) { x = -x; }
+            if (x > tot) { x = 2 * tot - x; }
         }
-        return logHastings;
+        x1 = x;
+        x2 = tot - x;
     }
-    */
-    if (2*n > dim) {
-        n = dim/2;
+    return 0.;
+}
+
+// resamples the whole profile from a Dirichlet centred on it: x' ~ Dir(concentration * x).
+// The log-Hastings ratio is accumulated during the draw so that the old profile need not be
+// kept: with g_i ~ Gamma(c x_i), S = sum g_i and x'_i = g_i / S,
+//   log q(x|x') - log q(x'|x) = - sum lgamma(c x'_i) + sum (c x'_i - 1) log x_i
+//                               + sum lgamma(c x_i) - sum (c x_i - 1) log x'_i
+template <class Profile, class Gen>
+double profile_dirichlet(Profile& profile, double concentration, Gen& gen) {
+    size_t dim = profile.size();
+    double sum_g{0}, sum_g_logx{0}, sum_logx{0}, sum_a_logg{0}, sum_lgam_a{0};
+    for (auto& x : profile) {
+        double a = concentration * x;
+        double g = positive_real(GammaSampler(positive_real(a))(gen));
+        double logx = log(x);
+        sum_g += g;
+        sum_g_logx += g * logx;
+        sum_logx += logx;
+        sum_a_logg += (a - 1) * log(g);
+        sum_lgam_a += std::lgamma(a);
+        x = g;
     }
-    std::vector<int> indices(2*n,0);
-    draw_with_replacement(indices,dim,gen);
-    for (int i=0; i<n; i++) {
-        int i1 = indices[2*i];
-        int i2 = indices[2*i+1];
-        double tot = profile[i1] + profile[i2];
-        double x = profile[i1];
-
-        double h = tot * tuning * (draw_uniform(gen) - 0.5);
-        x += h;
-        while ((x < 0) || (x > tot)) {
-            if (x < 0) {
-                x = -x;
-            }
-            if (x > tot) {
-                x = 2 * tot - x;
-            }
-        }
-        profile[i1] = x;
-        profile[i2] = tot - x;
-        if (!profile[i1]) {
-            profile[i1] = 1e-50;
-        }
-        if (!profile[i2]) {
-            profile[i2] = 1e-50;
-        }
+    double sum_lgam_new{0};
+    for (auto& x : profile) {
+        x /= sum_g;
+        sum_lgam_new += std::lgamma(concentration * x);
     }
-    return ret;
+    return -sum_lgam_new + concentration * sum_g_logx / sum_g - sum_logx + sum_lgam_a -
+           (sum_a_logg - (concentration - dim) * log(sum_g));
 }
 
+// multiplies n distinct components x_c by m_c = exp(tuning * (u_c - 0.5)) and renormalizes by
+// Z = 1 + sum x_c (m_c - 1); the jacobian of this map on the simplex is prod m_c / Z^dim
+template <class Profile, class Gen>
+double profile_scale(Profile& profile, int n, double tuning, Gen& gen) {
+    size_t dim = profile.size();
+    assert(dim > 1);
+    size_t nb_components = std::min(size_t(std::max(n, 1)), dim);
+    const size_t* indices = draw_distinct_indices(nb_components, dim, gen);
+    double sum_log_m = 0;
+    for (size_t c = 0; c < nb_components; c++) {
+        double log_m = tuning * (draw_uniform(gen) - 0.5);
+        profile[indices[c]] *= exp(log_m);
+        sum_log_m += log_m;
+    }
+    // Z is recomputed as the actual sum rather than from its closed form, so that rounding
+    // errors on the sum do not accumulate over iterations
+    double z = 0;
+    for (auto x : profile) { z += x; }
+    for (auto& x : profile) { x /= z; }
+    return sum_log_m - dim * log(z);
+}
 
 struct proposals    {
     static auto scaling(double tuning) {
@@ -175,6 +179,20 @@ struct proposals    {
         return [tuning] (auto& value, auto& gen) {return slide(value, tuning, gen);};
     }
 
+    static auto profile_sliding(int n, double tuning) {
+        return [n, tuning] (auto& value, auto& gen) {return profile_move(value, n, tuning, gen);};
+    }
+
+    static auto profile_dirichlet(double concentration) {
+        return [concentration] (auto& value, auto& gen) {
+            return ::profile_dirichlet(value, concentration, gen);
+        };
+    }
+
+    static auto profile_scaling(int n, double tuning) {
+        return [n, tuning] (auto& value, auto& gen) {return profile_scale(value, n, tuning, gen);};
+    }
+
 };
 
 template<class T>
@@ -0,0 +1,160 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <assert.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "mcmc_utils.hpp"
+
+/*==================================================================================================
+~~ Move scheduler ~~
+Moves are registered once as callables move(gen) with a name, a number of repetitions and a weight
+(blankets such as matrix_row_logprob(K_(m)) are built at registration, not at each iteration).
+The schedule is compiled into a flat dispatch table of (function pointer, closure) entries:
+  - systematic scan: each sweep calls every move nrep times, in registration order
+  - random scan: each sweep makes as many calls as the systematic scan, each call picking a move
+    with probability proportional to its weight
+==================================================================================================*/
+template <class Gen>
+class MoveScheduler {
+    struct Move {
+        std::string name;
+        std::shared_ptr<void> closure;
+        void (*call)(void*, Gen&);
+        size_t nrep;
+        double weight;
+        size_t nb_calls{0};
+        double seconds{0};
+    };
+
+    std::vector<Move> _moves;
+    std::vector<size_t> _table;  // systematic: sequence of move indices
+    std::vector<double> _cumulative_weights;  // random scan
+    bool _random_scan{false};
+    bool _timing{false};
+    bool _compiled{false};
+
+    void dispatch(size_t index, Gen& gen) {
+        auto& move = _moves[index];
+        if (_timing) {
+            auto start = std::chrono::steady_clock::now();
+            move.call(move.closure.get(), gen);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            move.seconds += elapsed.count();
+        } else {
+            move.call(move.closure.get(), gen);
+        }
+        move.nb_calls++;
+    }
+
+  public:
+    enum scan { systematic, random };
+
+    MoveScheduler(scan s = systematic) : _random_scan(s == random) {}
+
+    template <class F>
+    void add(std::string name, F f, size_t nrep = 1, double weight = 1.) {
+        assert(weight >= 0);
+        auto call = [](void* closure, Gen& gen) { (*static_cast<F*>(closure))(gen); };
+        _moves.push_back({name, std::make_shared<F>(std::move(f)), call, nrep, weight});
+        _compiled = false;
+    }
+
+    void compile() {
+        _table.clear();
+        _cumulative_weights.clear();
+        double tot = 0;
+        for (size_t m = 0; m < _moves.size(); m++) {
+            _table.insert(_table.end(), _moves[m].nrep, m);
+            tot += _moves[m].weight;
+            _cumulative_weights.push_back(tot);
+        }
+        _compiled = true;
+    }
+
+    void run(size_t nb_sweeps, Gen& gen) {
+        if (!_compiled) { compile(); }
+        for (size_t sweep = 0; sweep < nb_sweeps; sweep++) {
+            if (_random_scan) {
+                double tot = _cumulative_weights.back();
+                for (size_t call = 0; call < _table.size(); call++) {
+                    double u = draw_uniform(gen) * tot;
+                    auto it = std::upper_bound(_cumulative_weights.begin(),
+                                               _cumulative_weights.end(), u);
+                    dispatch(std::min(size_t(it - _cumulative_weights.begin()), _moves.size() - 1),
+                             gen);
+                }
+            } else {
+                for (auto m : _table) { dispatch(m, gen); }
+            }
+        }
+    }
+
+    //==============================================================================================
+    // profiling
+    void enable_timing(bool timing = true) { _timing = timing; }
+
+    void reset_counters() {
+        for (auto& m : _moves) {
+            m.nb_calls = 0;
+            m.seconds = 0;
+        }
+    }
+
+    size_t nb_calls(const std::string& name) const {
+        auto it = std::find_if(_moves.begin(), _moves.end(),
+                               [&name](const Move& m) { return m.name == name; });
+        assert(it != _moves.end());
+        return it->nb_calls;
+    }
+
+    double seconds(const std::string& name) const {
+        auto it = std::find_if(_moves.begin(), _moves.end(),
+                               [&name](const Move& m) { return m.name == name; });
+        assert(it != _moves.end());
+        return it->seconds;
+    }
+
+    void print_timings(std::ostream& os) const {
+        for (auto& m : _moves) {
+            os << m.name << "\t" << m.nb_calls << " calls\t" << m.seconds << "s";
+            if (m.nb_calls > 0) { os << "\t" << 1e6 * m.seconds / m.nb_calls << "us/call"; }
+            os << "\n";
+        }
+    }
+};
+
+template <class Gen>
+auto make_scheduler(Gen&, typename MoveScheduler<Gen>::scan s = MoveScheduler<Gen>::systematic) {
+    return MoveScheduler<Gen>(s);
+}
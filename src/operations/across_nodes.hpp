@@ -33,6 +33,12 @@ license and that you accept its terms.*/
 template <class T, class F>
 void across_nodes(T& x, F&& f);  // forward decl
 
+template <class T, class Transform, class F>
+void across_nodes_hoisted(T& x, Transform transform, F f);  // forward decl
+
+template <class T, class Transform, class F>
+void across_nodes_weighted(T& x, Transform transform, F f);  // forward decl
+
 namespace overloads {
     template <class Distrib, class T, class F, class Params, class... Keys, class... Indexes>
     void unpack_params(Distrib, T& x, F f, const Params& params, std::tuple<Keys...>,
@@ -96,6 +102,14 @@ namespace overloads {
         }
     }
 
+    // zeros that are not stored are passed as copies
+    template <class Matrix, class F>
+    void across_nodes(node_sparse_matrix_tag, Matrix& m, F f) {
+        using keys = param_keys_t<node_distrib_t<Matrix>>;
+        auto& data = get<value>(m);
+        apply_block(UseNodeContext<F, keys>{f}, m, 0, data.nb_rows, 0, data.nb_cols);
+    }
+
     template <class Cubix, class F>
     void across_nodes(node_cubix_tag, Cubix& m, F f) {
         using distrib = node_distrib_t<Cubix>;
@@ -164,3 +178,137 @@ template <class T, class F>
 void across_nodes(T& x, F&& f) {
     overloads::across_nodes(type_tag(x), x, std::forward<F>(f));
 }
+
+/*==================================================================================================
+~~ Traversal with hoisted params ~~
+across_nodes_hoisted(x, transform, f) calls f(distrib, value, transform(distrib, params...)) for
+all values in x, computing transform only once for the values that share their params (see
+hoisting.hpp). Nodes other than arrays, matrices and cubices are traversed as in across_nodes.
+==================================================================================================*/
+namespace overloads {
+    template <class Tag, class T, class Transform, class F>
+    void across_nodes_hoisted(Tag, T& x, Transform transform, F f) {
+        ::across_nodes(x, [&transform, &f](auto distrib, auto& x, auto... params) {
+            f(distrib, x, transform(distrib, params...));
+        });
+    }
+
+    template <class Array, class Transform, class F>
+    void across_nodes_hoisted(node_array_tag, Array& a, Transform transform, F f) {
+        auto hoisted = make_hoisted_params(a, transform);
+        UseHoistedNodeContext<decltype(hoisted), Transform, F, param_keys_t<node_distrib_t<Array>>>
+            context{&hoisted, transform, f};
+        for (size_t i = 0; i < get<value>(a).size(); i++) { apply(context, a, i); }
+    }
+
+    template <class Matrix, class Transform, class F>
+    void across_nodes_hoisted(node_matrix_tag, Matrix& m, Transform transform, F f) {
+        auto hoisted = make_hoisted_params(m, transform);
+        UseHoistedNodeContext<decltype(hoisted), Transform, F, param_keys_t<node_distrib_t<Matrix>>>
+            context{&hoisted, transform, f};
+        for (size_t i = 0; i < get<value>(m).size(); i++) {
+            for (size_t j = 0; j < get<value>(m)[i].size(); j++) { apply(context, m, i, j); }
+        }
+    }
+
+    template <class Cubix, class Transform, class F>
+    void across_nodes_hoisted(node_cubix_tag, Cubix& m, Transform transform, F f) {
+        auto hoisted = make_hoisted_params(m, transform);
+        UseHoistedNodeContext<decltype(hoisted), Transform, F, param_keys_t<node_distrib_t<Cubix>>>
+            context{&hoisted, transform, f};
+        for (size_t i = 0; i < get<value>(m).size(); i++) {
+            for (size_t j = 0; j < get<value>(m)[i].size(); j++) {
+                for (size_t k = 0; k < get<value>(m)[i][j].size(); k++) {
+                    apply(context, m, i, j, k);
+                }
+            }
+        }
+    }
+
+    template <class Matrix, class Transform, class F>
+    void across_nodes_hoisted(node_sparse_matrix_tag, Matrix& m, Transform transform, F f) {
+        auto hoisted = make_hoisted_params(m, transform);
+        UseHoistedNodeContext<decltype(hoisted), Transform, F, param_keys_t<node_distrib_t<Matrix>>>
+            context{&hoisted, transform, f};
+        apply_block(context, m, 0, get<value>(m).nb_rows, 0, get<value>(m).nb_cols);
+    }
+
+    template <class... SubsetArgs, class Transform, class F>
+    void across_nodes_hoisted(unknown_tag, NodeSubset<SubsetArgs...>& subset, Transform transform,
+                              F f) {
+        subset.across_nodes_hoisted(transform, f);
+    }
+
+    template <class... CollecArgs, class Transform, class F>
+    void across_nodes_hoisted(unknown_tag, SetCollection<CollecArgs...>& colec, Transform transform,
+                              F f) {
+        colec.across_elements([transform, f](auto& e) { ::across_nodes_hoisted(e, transform, f); });
+    }
+}  // namespace overloads
+
+template <class T, class Transform, class F>
+void across_nodes_hoisted(T& x, Transform transform, F f) {
+    overloads::across_nodes_hoisted(type_tag(x), x, transform, f);
+}
+
+/*==================================================================================================
+~~ Weighted traversal ~~
+across_nodes_weighted(x, transform, f) calls f(distrib, value, transformed, weight) and sums to
+the same as across_nodes_hoisted with weight 1 for all values, but values may stand for several
+elements: the unique patterns of compressed nodes are weighted by their counts, and the zeros of
+sparse matrices are passed once per distinct param value (see apply_block).
+==================================================================================================*/
+namespace overloads {
+    template <class Tag, class T, class Transform, class F>
+    void across_nodes_weighted(Tag, T& x, Transform transform, F f) {
+        ::across_nodes_hoisted(x, transform, [&f](auto distrib, auto& x, const auto& transformed) {
+            f(distrib, x, transformed, 1.0);
+        });
+    }
+
+    template <class Array, class Transform, class F>
+    void across_nodes_weighted(node_array_tag, Array& a, Transform transform, F f) {
+        auto hoisted = make_hoisted_params(a, transform);
+        UseWeightedNodeContext<decltype(hoisted), Transform, F, param_keys_t<node_distrib_t<Array>>>
+            context{&hoisted, transform, f};
+        for (size_t i = 0; i < get<value>(a).size(); i++) { apply(context, a, i); }
+    }
+
+    template <class Matrix, class Transform, class F>
+    void across_nodes_weighted(node_matrix_tag, Matrix& m, Transform transform, F f) {
+        auto hoisted = make_hoisted_params(m, transform);
+        UseWeightedNodeContext<decltype(hoisted), Transform, F,
+                               param_keys_t<node_distrib_t<Matrix>>>
+            context{&hoisted, transform, f};
+        for (size_t i = 0; i < get<value>(m).size(); i++) {
+            for (size_t j = 0; j < get<value>(m)[i].size(); j++) { apply(context, m, i, j); }
+        }
+    }
+
+    template <class Matrix, class Transform, class F>
+    void across_nodes_weighted(node_sparse_matrix_tag, Matrix& m, Transform transform, F f) {
+        auto hoisted = make_hoisted_params(m, transform);
+        UseWeightedNodeContext<decltype(hoisted), Transform, F,
+                               param_keys_t<node_distrib_t<Matrix>>>
+            context{&hoisted, transform, f};
+        apply_block(context, m, 0, get<value>(m).nb_rows, 0, get<value>(m).nb_cols);
+    }
+
+    template <class... SubsetArgs, class Transform, class F>
+    void across_nodes_weighted(unknown_tag, NodeSubset<SubsetArgs...>& subset, Transform transform,
+                               F f) {
+        subset.across_nodes_weighted(transform, f);
+    }
+
+    template <class... CollecArgs, class Transform, class F>
+    void across_nodes_weighted(unknown_tag, SetCollection<CollecArgs...>& colec,
+                               Transform transform, F f) {
+        colec.across_elements(
+            [transform, f](auto& e) { ::across_nodes_weighted(e, transform, f); });
+    }
+}  // namespace overloads
+
+template <class T, class Transform, class F>
+void across_nodes_weighted(T& x, Transform transform, F f) {
+    overloads::across_nodes_weighted(type_tag(x), x, transform, f);
+}
@@ -51,6 +51,12 @@ namespace overloads {
         }
     }
 
+    // values of sparse matrices are copies (zeros are not stored)
+    template <class Matrix, class F>
+    void across_values(node_sparse_matrix_tag, Matrix& m, const F& f) {
+        apply_block(f, m, 0, get<value>(m).nb_rows, 0, get<value>(m).nb_cols);
+    }
+
     template <class Cubix, class F>
     void across_values(node_cubix_tag, Cubix& m, const F& f) {
         for (auto& v : get<value>(m)) {
@@ -74,3 +80,28 @@ template <class T, class F>
 void across_values(T& x, F&& f) {
     overloads::across_values(type_tag(x), x, std::forward<F>(f));
 }
+
+//==================================================================================================
+// across_weighted_values(x, f) calls f(value, weight) for the values of a node array (or the rows
+// of a node matrix), where weight is the count of the pattern for compressed nodes and 1 otherwise
+// (e.g., to gather sufficient statistics)
+namespace overloads {
+    template <class Array, class F>
+    void across_weighted_values(node_array_tag, Array& a, const F& f) {
+        for (size_t i = 0; i < get<value>(a).size(); i++) {
+            f(get<value>(a)[i], pattern_weight(has_pattern_counts<Array>(), a, i));
+        }
+    }
+
+    template <class Matrix, class F>
+    void across_weighted_values(node_matrix_tag, Matrix& m, const F& f) {
+        for (size_t i = 0; i < get<value>(m).size(); i++) {
+            f(get<value>(m)[i], pattern_weight(has_pattern_counts<Matrix>(), m, i));
+        }
+    }
+}  // namespace overloads
+
+template <class T, class F>
+void across_weighted_values(T& x, F&& f) {
+    overloads::across_weighted_values(type_tag(x), x, std::forward<F>(f));
+}
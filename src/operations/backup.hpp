@@ -28,6 +28,8 @@ license and that you accept its terms.*/
 
 #include "raw_value.hpp"
 #include "structure/introspection.hpp"
+#include "structure/ragged.hpp"
+#include "structure/sparse_matrix.hpp"
 
 template <class T>
 auto backup(T& x);  // forward decl
@@ -40,7 +42,7 @@ namespace overloads {
 
     template <class Node, class Subset>
     auto backup(unknown_tag, NodeSubset<Node, Subset>& subset) {
-        using T = typename node_distrib_t<Node>::T;
+        using T = value_backup_t<typename node_distrib_t<Node>::T>;
         std::vector<T> result;
         subset.across_values([&result](auto& x) { result.push_back(x); });
         return result;
@@ -75,8 +77,8 @@ namespace overloads {
         }
     }
 
-    template <class Node, class T = typename node_distrib_t<Node>::T>
-    void restore(node_matrix_tag, Node& node, matrix<T>& backup) {
+    template <class Node, class Row, class Alloc>
+    void restore(node_matrix_tag, Node& node, std::vector<Row, Alloc>& backup) {
         assert(backup.size() == get<value>(node).size());
         assert(backup.size() > 0);
         assert(backup.at(0).size() == get<value>(node).at(0).size());
@@ -85,12 +87,23 @@ namespace overloads {
         }
     }
 
-    template <class Node, class T = typename node_distrib_t<Node>::T>
-    void restore(node_array_tag, Node& node, std::vector<T>& backup) {
+    template <class Node, class T, class Alloc>
+    void restore(node_array_tag, Node& node, std::vector<T, Alloc>& backup) {
         assert(backup.size() == get<value>(node).size());
         get<value>(node).assign(backup.begin(), backup.end());
     }
 
+    // ragged arrays are restored with a single copy of their buffer
+    template <class Node, class U>
+    void restore(node_array_tag, Node& node, RaggedArray<U>& backup) {
+        get<value>(node).copy_values(backup);
+    }
+
+    template <class Node, class T>
+    void restore(node_sparse_matrix_tag, Node& node, SparseMatrix<T>& backup) {
+        get<value>(node) = backup;
+    }
+
     template <class Node, class T = typename node_distrib_t<Node>::T>
     void restore(node_tree_process_tag, Node& node, std::vector<T>& backup) {
         assert(backup.size() == get<value>(node).size());
@@ -102,7 +115,8 @@ namespace overloads {
         get<value>(node) = backup;
     }
 
-    template <class Node, class Subset, class T = typename node_distrib_t<Node>::T>
+    template <class Node, class Subset,
+              class T = value_backup_t<typename node_distrib_t<Node>::T>>
     void restore(unknown_tag, NodeSubset<Node, Subset>& subset, std::vector<T>& backup) {
         auto it = backup.begin();
         subset.across_values([&it](auto& x) {
@@ -26,6 +26,8 @@ license and that you accept its terms.*/
 
 #pragma once
 
+#include <assert.h>
+#include <type_traits>
 #include "across_nodes.hpp"
 #include "structure/distrib_utils.hpp"
 #include "structure/type_tag.hpp"
@@ -33,10 +35,57 @@ license and that you accept its terms.*/
 /*==================================================================================================
 ~~ Generic version that unpacks probnode objects ~~
 ==================================================================================================*/
+namespace overloads {
+    template <class Distrib, class X, class... Args>
+    void draw_value(std::true_type /* stored as Distrib::T */, X& x, Args&&... args) {
+        Distrib::draw(x, std::forward<Args>(args)...);
+    }
+
+    // compact or reduced-precision storage (see make_compact_node_array and
+    // make_node_array_with_precision): drawn through a temporary
+    template <class Distrib, class X, class... Args>
+    void draw_value(std::false_type, X& x, Args&&... args) {
+        typename Distrib::T v = x;
+        Distrib::draw(v, std::forward<Args>(args)...);
+        x = v;
+        assert((std::is_floating_point<X>::value or typename Distrib::T(x) == v) &&
+               "value does not fit in compact storage");
+    }
+
+    template <class Tag, class T, class Gen>
+    void draw(Tag, T& x, Gen& gen) {
+        auto draw_node = [&gen](auto distrib, auto& x, auto... params) {
+            using D = decltype(distrib);
+            draw_value<D>(std::is_same<std::decay_t<decltype(x)>, typename D::T>(), x, params...,
+                          gen);
+        };
+        ::across_nodes(x, draw_node);
+    }
+
+    template <class Array, class Gen, class... Keys>
+    void array_draw(std::true_type, Array& a, Gen& gen, std::tuple<Keys...>) {
+        node_distrib_t<Array>::array_draw(get<value>(a), get<Keys>(get<params>(a))..., gen);
+    }
+
+    template <class Array, class Gen, class Keys>
+    void array_draw(std::false_type, Array& a, Gen& gen, Keys) {
+        draw(unknown_tag(), a, gen);
+    }
+
+    // node arrays whose distribution provides a batched sampler are drawn in one call (unless
+    // they use compact storage)
+    template <class Array, class Gen>
+    void draw(node_array_tag, Array& a, Gen& gen) {
+        using distrib = node_distrib_t<Array>;
+        using stored_as_T = std::is_same<std::decay_t<decltype(get<value>(a))>,
+                                         std::vector<typename distrib::T>>;
+        array_draw(std::integral_constant<bool, has_array_draw<distrib>::value and
+                                                    stored_as_T::value>(),
+                   a, gen, param_keys_t<distrib>());
+    }
+}  // namespace overloads
+
 template <class T, class Gen>
 void draw(T& x, Gen& gen) {
-    auto draw_node = [&gen](auto distrib, auto& x, auto... params) {
-        decltype(distrib)::draw(x, params..., gen);
-    };
-    across_nodes(x, draw_node);
+    overloads::draw(type_tag(x), x, gen);
 }
@@ -26,6 +26,8 @@ license and that you accept its terms.*/
 
 #pragma once
 
+#include <tuple>
+#include <utility>
 #include "across_model_nodes.hpp"
 #include "across_nodes.hpp"
 #include "structure/visitor.hpp"
@@ -55,14 +57,278 @@ class LogProbTraitVisitor : public TraitVisitor<LogProbTraitVisitor, is_node, is
     using Parent::operator();
 };
 
-// use of visitor deactivated (subsets do not pass through)
+namespace overloads {
+    template <class F, class Tuple, size_t... Is>
+    double unpack_tuple(F f, const Tuple& t, std::index_sequence<Is...>) {
+        return f(std::get<Is>(t)...);
+    }
+
+    template <class Distrib, class T, class... Params>
+    double param_logprob(std::true_type, Distrib, T& x, Params... params) {
+        return Distrib::param_logprob(x, params...);
+    }
+
+    template <class Distrib, class T, class... Params>
+    double param_logprob(std::false_type, Distrib, T& x, Params... params) {
+        return Distrib::logprob(x, params...);
+    }
+
+    // logprob kernels working on params that have been transformed once for all the values that
+    // share them (see across_nodes_hoisted); distributions without transform_params get their
+    // params as a tuple
+    template <class Distrib, class = void>
+    struct logprob_kernels {
+        static constexpr bool transforms_params = false;
+
+        template <class... Params>
+        static auto transform(Params... params) {
+            return std::make_tuple(params...);
+        }
+
+        template <class T, class Tuple>
+        static double logprob(T& x, const Tuple& params) {
+            return unpack_tuple([&x](auto... params) { return Distrib::logprob(x, params...); },
+                                params, std::make_index_sequence<std::tuple_size<Tuple>::value>());
+        }
+
+        template <class T, class Tuple>
+        static double param_logprob(T& x, const Tuple& params) {
+            return unpack_tuple(
+                [&x](auto... params) {
+                    return overloads::param_logprob(has_data_logprob<Distrib>(), Distrib{}, x,
+                                                    params...);
+                },
+                params, std::make_index_sequence<std::tuple_size<Tuple>::value>());
+        }
+    };
+
+    template <class Distrib>
+    struct logprob_kernels<Distrib, to_void<decltype(Distrib::transform_params)>> {
+        static constexpr bool transforms_params = true;
+
+        template <class... Params>
+        static auto transform(Params... params) {
+            return Distrib::transform_params(params...);
+        }
+
+        template <class T, class Transformed>
+        static double logprob(T& x, const Transformed& params) {
+            return Distrib::transformed_logprob(x, params);
+        }
+
+        template <class T, class Transformed>
+        static double param_logprob(std::true_type, T& x, const Transformed& params) {
+            return Distrib::transformed_param_logprob(x, params);
+        }
+
+        template <class T, class Transformed>
+        static double param_logprob(std::false_type, T& x, const Transformed& params) {
+            return Distrib::transformed_logprob(x, params);
+        }
+
+        template <class T, class Transformed>
+        static double param_logprob(T& x, const Transformed& params) {
+            return param_logprob(has_data_logprob<Distrib>(), x, params);
+        }
+    };
+
+    template <class T>
+    struct node_of {
+        using type = T;
+    };
+
+    template <class Node, class Subset>
+    struct node_of<NodeSubset<Node, Subset>> {
+        using type = Node;
+    };
+
+    // nodes (and subsets of nodes) whose elements all have weight 1
+    template <class T, class Node = typename node_of<T>::type>
+    struct unweighted_traversal
+        : std::integral_constant<bool, is_node<Node>::value and !has_pattern_counts<Node>::value and
+                                           !is_node_sparse_matrix<Node>::value> {};
+
+    // hoisting only pays off if the distribution transforms its params and some params are shared
+    // between elements (i.e., do not depend on all the indices)
+    template <class Node, class Distrib = node_distrib_t<Node>>
+    struct worth_hoisting {
+        using indices = nb_indices<decltype(type_tag(std::declval<Node&>()))>;
+        static constexpr size_t all = (size_t(1) << indices::value) - 1;
+        static constexpr size_t mask = node_param_index_mask<Node, param_keys_t<Distrib>>::value;
+        static constexpr bool value =
+            logprob_kernels<Distrib>::transforms_params and (mask & all) != all;
+    };
+
+    template <class T, bool = unweighted_traversal<T>::value>
+    struct direct_traversal : std::false_type {};
+
+    template <class T>
+    struct direct_traversal<T, true>
+        : std::integral_constant<bool, !worth_hoisting<typename node_of<T>::type>::value> {};
+}  // namespace overloads
+
+namespace overloads {
+    template <class T>
+    double logprob_sum(std::true_type /* direct */, T& x) {
+        double result = 0;
+        across_nodes(x, [&result](auto distrib, auto& x, auto... params) {
+            result += decltype(distrib)::logprob(x, params...);
+        });
+        return result;
+    }
+
+    template <class T>
+    double logprob_sum(std::false_type, T& x) {
+        double result = 0;
+        across_nodes_weighted(
+            x,
+            [](auto distrib, auto... params) {
+                return logprob_kernels<decltype(distrib)>::transform(params...);
+            },
+            [&result](auto distrib, auto& x, const auto& params, double weight) {
+                result += weight * logprob_kernels<decltype(distrib)>::logprob(x, params);
+            });
+        return result;
+    }
+}  // namespace overloads
+
+// use of visitor deactivated (subsets do not pass through); weighted traversal so that compressed
+// patterns and sparse zeros are evaluated once and shared params are transformed once (see
+// across_nodes_weighted), direct traversal when there is nothing to hoist (see direct_traversal)
 template <class T>
 double logprob(T& x) {
-    double result = 0;
-    auto logprob_node = [&result] (auto distrib, auto& x, auto... params) {
-        result += decltype(distrib)::logprob(x, params...);
-    };
-    across_nodes(x, logprob_node);
     // across_model_nodes(x, LogProbTraitVisitor{result});
+    return overloads::logprob_sum(overloads::direct_traversal<T>(), x);
+}
+
+namespace overloads {
+    template <class Distrib, class T>
+    double data_logprob(std::true_type, Distrib, T& x) {
+        return Distrib::data_logprob(x);
+    }
+
+    template <class Distrib, class T>
+    double data_logprob(std::false_type, Distrib, T&) {
+        return 0;
+    }
+}  // namespace overloads
+
+namespace overloads {
+    template <class T>
+    double param_logprob_sum(std::true_type /* direct */, T& x) {
+        double result = 0;
+        across_nodes(x, [&result](auto distrib, auto& x, auto... params) {
+            using D = decltype(distrib);
+            result += param_logprob(has_data_logprob<D>(), D{}, x, params...);
+        });
+        return result;
+    }
+
+    template <class T>
+    double param_logprob_sum(std::false_type, T& x) {
+        double result = 0;
+        across_nodes_weighted(
+            x,
+            [](auto distrib, auto... params) {
+                return logprob_kernels<decltype(distrib)>::transform(params...);
+            },
+            [&result](auto distrib, auto& x, const auto& params, double weight) {
+                result += weight * logprob_kernels<decltype(distrib)>::param_logprob(x, params);
+            });
+        return result;
+    }
+}  // namespace overloads
+
+// logprob without the terms that depend only on the values of x (e.g., -log(k!) for poisson
+// counts); when x is observed, these terms are constant and cancel out in MH ratios
+template <class T>
+double param_logprob(T& x) {
+    return overloads::param_logprob_sum(overloads::direct_traversal<T>(), x);
+}
+
+namespace overloads {
+    // terms of the logprob that depend on a given role (see role_index), when the distribution
+    // provides them as partial_logprob_value/param1/param2; full logprob otherwise
+    template <class Distrib, int Role, class = void>
+    struct partial_logprob {
+        template <class T, class... Params>
+        static double compute(T& x, Params... params) {
+            return Distrib::logprob(x, params...);
+        }
+    };
+
+    template <class Distrib>
+    struct partial_logprob<Distrib, 0, to_void<decltype(Distrib::partial_logprob_value)>> {
+        template <class T, class... Params>
+        static double compute(T& x, Params... params) {
+            return Distrib::partial_logprob_value(x, params...);
+        }
+    };
+
+    template <class Distrib>
+    struct partial_logprob<Distrib, 1, to_void<decltype(Distrib::partial_logprob_param1)>> {
+        template <class T, class... Params>
+        static double compute(T& x, Params... params) {
+            return Distrib::partial_logprob_param1(x, params...);
+        }
+    };
+
+    template <class Distrib>
+    struct partial_logprob<Distrib, 2, to_void<decltype(Distrib::partial_logprob_param2)>> {
+        template <class T, class... Params>
+        static double compute(T& x, Params... params) {
+            return Distrib::partial_logprob_param2(x, params...);
+        }
+    };
+}  // namespace overloads
+
+namespace overloads {
+    template <class Role, class T>
+    double partial_logprob_sum(std::true_type /* plain node */, T& x) {
+        double result = 0;
+        across_nodes(x, [&result](auto distrib, auto& x, auto... params) {
+            using D = decltype(distrib);
+            result += partial_logprob<D, role_index<D, Role>::value>::compute(x, params...);
+        });
+        return result;
+    }
+
+    // compressed and sparse nodes (or models that may contain them): params are copied as a tuple
+    // per distinct value (see across_nodes_weighted)
+    template <class Role, class T>
+    double partial_logprob_sum(std::false_type, T& x) {
+        double result = 0;
+        across_nodes_weighted(
+            x, [](auto, auto... params) { return std::make_tuple(params...); },
+            [&result](auto distrib, auto& x, const auto& params, double weight) {
+                using D = decltype(distrib);
+                using partial = partial_logprob<D, role_index<D, Role>::value>;
+                result += weight * unpack_tuple(
+                                       [&x](auto... ps) { return partial::compute(x, ps...); },
+                                       params, std::make_index_sequence<std::tuple_size<
+                                                   std::decay_t<decltype(params)>>::value>());
+            });
+        return result;
+    }
+}  // namespace overloads
+
+// logprob restricted to the terms that depend on Role, which is either value or a param key
+// (e.g., shape for gamma_sr); the other terms cancel out in MH ratios of moves that only change
+// the node (or param) in that role
+template <class Role, class T>
+double partial_logprob(T& x) {
+    return overloads::partial_logprob_sum<Role>(overloads::unweighted_traversal<T>(), x);
+}
+
+// the terms left out by param_logprob (compute once after setting observed values)
+template <class T>
+double data_logprob(T& x) {
+    double result = 0;
+    across_nodes_weighted(
+        x, [](auto, auto...) { return 0; },
+        [&result](auto distrib, auto& x, int, double weight) {
+            result +=
+                weight * overloads::data_logprob(has_data_logprob<decltype(distrib)>(), distrib, x);
+        });
     return result;
 }
@@ -0,0 +1,449 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <array>
+#include "gather.hpp"
+#include "logprob.hpp"
+#include "structure/hoisting.hpp"
+
+/*==================================================================================================
+~~ Markov blankets derived from param bindings ~~
+Params built by the factories of array_utils.hpp from a node (one_to_one, n_to_n, mn_to_m, mn_to_mn,
+node values passed to make_node...) are BoundParams, which record the node value they read. For an
+element of a node, blanket_logprob and blanket_gather follow these bindings through the model to
+find the dnode elements to update and the node elements whose logprob depend on it, e.g.:
+    scaling_move(lambda_(m), blanket_logprob(m, lambda_(m)), 1.0, 1, gen,
+                 blanket_gather(m, lambda_(m)));
+Mixture params (n_to_mix, mn_to_mixn) record both the components and the allocation. Params given
+as user lambdas cannot be tracked and do not compile here (wrap them in indexed_param with their
+sources); models must list dnodes after the nodes they read.
+==================================================================================================*/
+
+namespace blanket_utils {
+
+    // part of a node that depends on the element being moved
+    struct dependence {
+        enum kind_t { none, element, row, column, whole } kind;
+        size_t nb_indices;  // of the node
+        size_t i, j;
+    };
+
+    inline bool operator==(const dependence& a, const dependence& b) {
+        return a.kind == b.kind and a.i == b.i and a.j == b.j;
+    }
+
+    inline dependence whole_node(size_t nb_indices) {
+        return {dependence::whole, nb_indices, 0, 0};
+    }
+
+    inline dependence merge(const dependence& a, const dependence& b) {
+        if (a.kind == dependence::none or a == b) { return b; }
+        if (b.kind == dependence::none) { return a; }
+        auto contains = [](const dependence& x, const dependence& e) {
+            return e.kind == dependence::element and
+                   ((x.kind == dependence::row and x.i == e.i) or
+                    (x.kind == dependence::column and x.j == e.j));
+        };
+        if (contains(a, b)) { return a; }
+        if (contains(b, a)) { return b; }
+        return whole_node(a.nb_indices);
+    }
+
+    // part of a child node (with nb_indices indices) reading d through a param of given index
+    // mask (see IndexedParam)
+    inline dependence propagate(const dependence& d, size_t mask, bool same_indices,
+                                size_t nb_indices) {
+        if (d.kind == dependence::none) { return d; }
+        if (same_indices and d.kind == dependence::element) {
+            if (d.nb_indices == 1 and nb_indices == 1 and mask == 1) {  // n_to_n
+                return {dependence::element, 1, d.i, 0};
+            }
+            if (d.nb_indices == 1 and nb_indices == 2 and mask == 1) {  // mn_to_m
+                return {dependence::row, 2, d.i, 0};
+            }
+            if (d.nb_indices == 1 and nb_indices == 2 and mask == 2) {  // mn_to_n
+                return {dependence::column, 2, 0, d.i};
+            }
+        }
+        if (same_indices and d.nb_indices == 2 and nb_indices == 2 and mask == 3) {  // mn_to_mn
+            return d;
+        }
+        return whole_node(nb_indices);
+    }
+
+    struct param_binding {
+        const void* source;
+        size_t mask;
+        bool same_indices;
+    };
+
+    using param_bindings = std::array<param_binding, 2>;
+
+    // user lambdas do not say which values they read, so blankets would silently miss nodes
+    template <class F>
+    param_bindings binding_of(const F&) {
+        static_assert(sizeof(F) == 0,
+                      "in markov blankets: param is not bound, build it with the factories of "
+                      "array_utils.hpp or with indexed_param and its sources");
+        return {};
+    }
+
+    // mixtures read both the components and the allocation
+    template <size_t Mask, class Array, class Alloc>
+    param_bindings binding_of(const MixtureParam<Mask, Array, Alloc>& param) {
+        return {{{param.array, Mask, false}, {param.alloc, Mask, true}}};
+    }
+
+    // constants, or user functions wrapped with their sources
+    template <size_t Mask, class F>
+    param_bindings binding_of(const IndexedParam<Mask, F>& param) {
+        return {{{param.sources[0].address, Mask, param.sources[0].same_indices},
+                 {param.sources[1].address, Mask, param.sources[1].same_indices}}};
+    }
+
+    template <size_t Mask, class Value, class Access>
+    param_bindings binding_of(const BoundParam<Mask, Value, Access>& param) {
+        return {{{param.source, Mask, true}, {nullptr, Mask, false}}};
+    }
+
+    // part of node that reads the value at address source, where d depends on the move
+    template <class Node, class... Keys>
+    dependence node_dependence(Node& node, const void* source, const dependence& d,
+                               std::tuple<Keys...>) {
+        constexpr size_t nb = nb_indices<decltype(type_tag(node))>::value;
+        std::array<param_bindings, sizeof...(Keys)> bindings{
+            {binding_of(get<params, Keys>(node))...}};
+        dependence result{dependence::none, nb, 0, 0};
+        for (auto& param : bindings) {
+            for (auto& b : param) {
+                if (b.source != nullptr and b.source == source) {
+                    result = merge(result, propagate(d, b.mask, b.same_indices, nb));
+                }
+            }
+        }
+        return result;
+    }
+
+    template <class Node>
+    dependence node_dependence(node_tag, Node& node, const void* source, const dependence& d) {
+        return node_dependence(node, source, d, param_keys_t<node_distrib_t<Node>>());
+    }
+
+    template <class Dnode>
+    dependence node_dependence(dnode_tag, Dnode& dnode, const void* source, const dependence& d) {
+        return node_dependence(dnode, source, d, param_keys_t<dnode_distrib_t<Dnode>>());
+    }
+
+    // tree processes and other fields are not tracked
+    template <class T>
+    dependence node_dependence(node_tree_process_tag, T&, const void*, const dependence&) {
+        return {dependence::none, 0, 0, 0};
+    }
+
+    template <class T>
+    dependence node_dependence(node_cond_tree_process_tag, T&, const void*, const dependence&) {
+        return {dependence::none, 0, 0, 0};
+    }
+
+    template <class T>
+    dependence node_dependence(unknown_tag, T&, const void*, const dependence&) {
+        return {dependence::none, 0, 0, 0};
+    }
+
+    template <class T>
+    dependence node_dependence(model_tag, T&, const void*, const dependence&) {
+        return {dependence::none, 0, 0, 0};
+    }
+
+    template <class T>
+    const void* value_address(node_tag, T& x) {
+        return &get<value>(x);
+    }
+
+    template <class T>
+    const void* value_address(dnode_tag, T& x) {
+        return &get<value>(x);
+    }
+
+    template <class T>
+    const void* value_address(unknown_tag, T&) {
+        return nullptr;
+    }
+
+    template <class T>
+    const void* value_address(model_tag, T&) {
+        return nullptr;
+    }
+
+    template <class M, class F, class... Fields>
+    void across_fields(M& m, F&& f, std::tuple<Fields...>) {
+        size_t index = 0;
+        int unused[] = {0, (f(index++, get<Fields>(m)), 0)...};
+        (void)unused;
+    }
+
+    template <class M>
+    using nb_fields = std::tuple_size<model_nodes<M>>;
+
+    // dependences of all the fields of the model on the value at address source, following
+    // dnodes recursively
+    template <class M>
+    void collect_dependences(M& m, const void* source, const dependence& d,
+                             std::array<dependence, nb_fields<M>::value>& deps) {
+        across_fields(m, [&](size_t index, auto& field) {
+            auto tag = type_tag(field);
+            auto dep = node_dependence(tag, field, source, d);
+            if (dep.kind == dependence::none) { return; }
+            auto merged = merge(deps[index], dep);
+            bool changed = !(merged == deps[index]);
+            deps[index] = merged;
+            if (changed and std::is_base_of<dnode_tag, decltype(tag)>::value) {
+                collect_dependences(m, value_address(tag, field), merged, deps);
+            }
+        }, model_nodes<M>());
+    }
+
+    // placeholders for the indices of the moved element, so that dependences can be computed once
+    // per node and instantiated for each element (see blanket_logprob)
+    constexpr size_t first_index = ~size_t(0);
+    constexpr size_t second_index = ~size_t(0) - 1;
+
+    inline size_t instantiate(size_t index, const std::array<size_t, 3>& is) {
+        return index == first_index ? is[0] : index == second_index ? is[1] : index;
+    }
+
+    inline dependence instantiate(const dependence& d, const std::array<size_t, 3>& is) {
+        return {d.kind, d.nb_indices, instantiate(d.i, is), instantiate(d.j, is)};
+    }
+
+    template <class M, class Node, class... Indices>
+    auto dependences(M& m, Node& node, Indices... is) {
+        using nb = nb_indices<decltype(type_tag(node))>;
+        static_assert(sizeof...(Indices) == nb::value, "in dependences: wrong number of indices");
+        std::array<dependence, nb_fields<M>::value> deps;
+        deps.fill({dependence::none, 0, 0, 0});
+        std::array<size_t, 3> indices{{size_t(is)..., 0}};
+        dependence d = sizeof...(Indices) == 0 ? whole_node(0)
+                                               : dependence{dependence::element, nb::value,
+                                                            indices[0], indices[1]};
+        collect_dependences(m, &get<value>(node), d, deps);
+        return deps;
+    }
+}  // namespace blanket_utils
+
+namespace overloads {
+    using blanket_utils::dependence;
+
+    template <class Node>
+    double blanket_logprob(node_array_tag, Node& node, const dependence& d) {
+        if (d.kind == dependence::element) {
+            auto subset = subsets::element(node, d.i);
+            return param_logprob(subset);
+        }
+        return param_logprob(node);
+    }
+
+    template <class Node>
+    double blanket_logprob(node_matrix_tag, Node& node, const dependence& d) {
+        if (d.kind == dependence::element) {
+            auto subset = subsets::element(node, d.i, d.j);
+            return param_logprob(subset);
+        } else if (d.kind == dependence::row) {
+            auto subset = subsets::row(node, d.i);
+            return param_logprob(subset);
+        } else if (d.kind == dependence::column) {
+            auto subset = subsets::column(node, d.j);
+            return param_logprob(subset);
+        }
+        return param_logprob(node);
+    }
+
+    template <class Node>
+    double blanket_logprob(node_sparse_matrix_tag, Node& node, const dependence& d) {
+        return blanket_logprob(node_matrix_tag(), node, d);
+    }
+
+    template <class Node>
+    double blanket_logprob(node_tag, Node& node, const dependence&) {
+        return param_logprob(node);
+    }
+
+    // no dependences there (see node_dependence)
+    template <class T>
+    double blanket_logprob(node_tree_process_tag, T&, const dependence&) {
+        return 0;
+    }
+
+    template <class T>
+    double blanket_logprob(node_cond_tree_process_tag, T&, const dependence&) {
+        return 0;
+    }
+
+    template <class T>
+    double blanket_logprob(dnode_tag, T&, const dependence&) {
+        return 0;
+    }
+
+    template <class T>
+    double blanket_logprob(unknown_tag, T&, const dependence&) {
+        return 0;
+    }
+
+    template <class T>
+    double blanket_logprob(model_tag, T&, const dependence&) {
+        return 0;
+    }
+
+    template <class Dnode>
+    void blanket_gather(dnode_array_tag, Dnode& dnode, const dependence& d) {
+        if (d.kind == dependence::element) {
+            auto subset = subsets::element(dnode, d.i);
+            gather(subset);
+        } else {
+            gather(dnode);
+        }
+    }
+
+    template <class Dnode>
+    void blanket_gather(dnode_matrix_tag, Dnode& dnode, const dependence& d) {
+        if (d.kind == dependence::element) {
+            auto subset = subsets::element(dnode, d.i, d.j);
+            gather(subset);
+        } else if (d.kind == dependence::row) {
+            auto subset = subsets::row(dnode, d.i);
+            gather(subset);
+        } else if (d.kind == dependence::column) {
+            auto subset = subsets::column(dnode, d.j);
+            gather(subset);
+        } else {
+            gather(dnode);
+        }
+    }
+
+    template <class Dnode>
+    void blanket_gather(dnode_tag, Dnode& dnode, const dependence&) {
+        gather(dnode);
+    }
+
+    template <class T>
+    void blanket_gather(node_tag, T&, const dependence&) {}
+
+    template <class T>
+    void blanket_gather(unknown_tag, T&, const dependence&) {}
+
+    template <class T>
+    void blanket_gather(model_tag, T&, const dependence&) {}
+}  // namespace overloads
+
+namespace blanket_utils {
+    template <class M>
+    using dependences_t = std::array<dependence, nb_fields<M>::value>;
+
+    // dependences on an element of node, with placeholder indices
+    template <class M, class Node>
+    struct dependence_pattern {
+        using nb = nb_indices<decltype(type_tag(std::declval<Node&>()))>;
+        dependences_t<M> element;
+
+        dependence_pattern(M& m, Node& node) : element(element_dependences(m, node, nb())) {}
+
+        static dependences_t<M> element_dependences(M& m, Node& node,
+                                                    std::integral_constant<size_t, 0>) {
+            return dependences(m, node);
+        }
+
+        static dependences_t<M> element_dependences(M& m, Node& node,
+                                                    std::integral_constant<size_t, 1>) {
+            return dependences(m, node, first_index);
+        }
+
+        static dependences_t<M> element_dependences(M& m, Node& node,
+                                                    std::integral_constant<size_t, 2>) {
+            return dependences(m, node, first_index, second_index);
+        }
+
+        template <class... Indices>
+        dependences_t<M> operator()(Indices... is) const {
+            static_assert(sizeof...(Indices) == nb::value,
+                          "in dependence_pattern: wrong number of indices");
+            std::array<size_t, 3> indices{{size_t(is)..., 0}};
+            dependences_t<M> result;
+            for (size_t k = 0; k < result.size(); k++) {
+                result[k] = instantiate(element[k], indices);
+            }
+            return result;
+        }
+    };
+
+    template <class M>
+    double blanket_logprob(M& m, const dependences_t<M>& deps) {
+        double result = 0;
+        across_fields(m, [&](size_t index, auto& field) {
+            if (deps[index].kind != dependence::none) {
+                result += overloads::blanket_logprob(type_tag(field), field, deps[index]);
+            }
+        }, model_nodes<M>());
+        return result;
+    }
+
+    template <class M>
+    void blanket_gather(M& m, const dependences_t<M>& deps) {
+        across_fields(m, [&](size_t index, auto& field) {
+            if (deps[index].kind != dependence::none) {
+                overloads::blanket_gather(type_tag(field), field, deps[index]);
+            }
+        }, model_nodes<M>());
+    }
+}  // namespace blanket_utils
+
+// logprob of the nodes that depend on the element (is...) of node (except node itself)
+template <class M, class Node, class... Indices>
+double markov_blanket_logprob(M& m, Node& node, Indices... is) {
+    return blanket_utils::blanket_logprob(m, blanket_utils::dependences(m, node, is...));
+}
+
+// updates the dnodes that depend on the element (is...) of node, in model order
+template <class M, class Node, class... Indices>
+void markov_blanket_gather(M& m, Node& node, Indices... is) {
+    blanket_utils::blanket_gather(m, blanket_utils::dependences(m, node, is...));
+}
+
+// lp and update callbacks for moves on node (called with the indices of the moved element); the
+// dependences are derived once, when the callbacks are built
+template <class M, class Node>
+auto blanket_logprob(M& m, Node& node) {
+    blanket_utils::dependence_pattern<M, Node> pattern(m, node);
+    return [&m, pattern](auto... is) { return blanket_utils::blanket_logprob(m, pattern(is...)); };
+}
+
+template <class M, class Node>
+auto blanket_gather(M& m, Node& node) {
+    blanket_utils::dependence_pattern<M, Node> pattern(m, node);
+    return [&m, pattern](auto... is) { blanket_utils::blanket_gather(m, pattern(is...)); };
+}
@@ -27,6 +27,9 @@ license and that you accept its terms.*/
 #pragma once
 
 #include <assert.h>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
 #include "raw_value.hpp"
 
 template <class ProbNode, class Distrib = node_distrib_t<ProbNode>>
@@ -36,27 +39,115 @@ void set_value(ProbNode& node, typename Distrib::T value) {
 }
 
 template <class ProbNode, class Distrib = node_distrib_t<ProbNode>>
-void set_value(ProbNode& node, std::vector<typename Distrib::T> values) {
+void set_value(ProbNode& node, const std::vector<typename Distrib::T>& values) {
     static_assert(is_node_array<ProbNode>::value, "this set_value overload expects an array!");
     assert(values.size() == get<value>(node).size());
-    for (size_t i = 0; i < values.size(); i++) { raw_value(node, i) = values[i]; }
+    std::copy(values.begin(), values.end(), get<value>(node).begin());
 }
 
 template <class ProbNode, class Distrib = node_distrib_t<ProbNode>>
-void set_value(ProbNode& node, matrix<typename Distrib::T> values) {
+void set_value(ProbNode& node, const matrix<typename Distrib::T>& values) {
     static_assert(is_node_matrix<ProbNode>::value, "this set_value overload expects a matrix!");
     assert(values.size() == get<value>(node).size());
     assert(values.size() > 0);
     assert(values.at(0).size() == get<value>(node).at(0).size());
     for (size_t i = 0; i < values.size(); i++) {
-        for (size_t j = 0; j < values[0].size(); j++) { raw_value(node, i, j) = values[i][j]; }
+        assert(values[i].size() == values[0].size());
+        std::copy(values[i].begin(), values[i].end(), get<value>(node)[i].begin());
     }
 }
 
+//==================================================================================================
+// adopts the buffer of values instead of copying it; element storage is replaced, so pointers or
+// references to single elements of the node (e.g., a lone node built on raw_value(node, i)) are
+// invalidated, whereas params bound to the whole array or matrix remain valid
+namespace overloads {
+    template <class ProbNode, class Values>
+    void adopt_value(std::true_type /* same storage */, ProbNode& node, Values&& values) {
+        get<value>(node) = std::move(values);
+    }
+
+    // compact storage (see make_compact_node_array): copied
+    template <class ProbNode, class Values>
+    void adopt_value(std::false_type, ProbNode& node, Values&& values) {
+        ::set_value(node, static_cast<const Values&>(values));
+    }
+
+    template <class ProbNode, class Values>
+    using same_storage = std::is_same<std::decay_t<decltype(get<value>(std::declval<ProbNode&>()))>,
+                                      std::decay_t<Values>>;
+
+    template <class T>
+    bool all_rows_have_size(const matrix<T>& values, size_t size) {
+        return std::all_of(values.begin(), values.end(),
+                           [size](const std::vector<T>& row) { return row.size() == size; });
+    }
+}  // namespace overloads
+
+template <class ProbNode, class Distrib = node_distrib_t<ProbNode>>
+void adopt_value(ProbNode& node, std::vector<typename Distrib::T>&& values) {
+    static_assert(is_node_array<ProbNode>::value, "this adopt_value overload expects an array!");
+    assert(values.size() == get<value>(node).size());
+    overloads::adopt_value(overloads::same_storage<ProbNode, decltype(values)>(), node,
+                           std::move(values));
+}
+
+template <class ProbNode, class Distrib = node_distrib_t<ProbNode>>
+void adopt_value(ProbNode& node, matrix<typename Distrib::T>&& values) {
+    static_assert(is_node_matrix<ProbNode>::value, "this adopt_value overload expects a matrix!");
+    assert(values.size() == get<value>(node).size());
+    assert(values.size() > 0);
+    assert(overloads::all_rows_have_size(values, get<value>(node).at(0).size()));
+    overloads::adopt_value(overloads::same_storage<ProbNode, decltype(values)>(), node,
+                           std::move(values));
+}
+
+// sets row index of a matrix
 template <class ProbNode, class Distrib = node_distrib_t<ProbNode>>
-void set_value(ProbNode& node, size_t index, std::vector<typename Distrib::T> values) {
+void set_value(ProbNode& node, size_t index, const std::vector<typename Distrib::T>& values) {
     static_assert(is_node_matrix<ProbNode>::value, "this set_value overload expects a matrix!");
-    assert(0 <= index && index < get<value>(node).size());
+    assert(index < get<value>(node).size());
     assert(values.size() == get<value>(node).at(index).size());
-    for (size_t j = 0; j < values.size(); j++) { raw_value(node, index, j) = values[j]; }
+    std::copy(values.begin(), values.end(), get<value>(node)[index].begin());
+}
+
+//==================================================================================================
+// bulk copies from a range [first, last) of values, e.g., a raw buffer read from a file (in
+// row-major order for matrices)
+namespace overloads {
+    template <class Array, class It>
+    void set_value_range(node_array_tag, Array& node, It first, It last) {
+        assert(size_t(std::distance(first, last)) == get<value>(node).size());
+        std::copy(first, last, get<value>(node).begin());
+    }
+
+    template <class Matrix, class It>
+    void set_value_range(node_matrix_tag, Matrix& node, It first, It last) {
+        auto& v = get<value>(node);
+        assert(v.size() > 0);
+        size_t nb_cols = v[0].size();
+        assert(size_t(std::distance(first, last)) == v.size() * nb_cols);
+        (void)last;
+        for (auto& row : v) {
+            std::copy(first, std::next(first, nb_cols), row.begin());
+            std::advance(first, nb_cols);
+        }
+    }
+}  // namespace overloads
+
+template <class ProbNode, class It>
+void set_value_range(ProbNode& node, It first, It last) {
+    static_assert(is_node_array<ProbNode>::value or is_node_matrix<ProbNode>::value,
+                  "set_value_range expects an array or a matrix!");
+    overloads::set_value_range(type_tag(node), node, first, last);
+}
+
+// same for row index of a matrix
+template <class ProbNode, class It>
+void set_value_range(ProbNode& node, size_t index, It first, It last) {
+    static_assert(is_node_matrix<ProbNode>::value,
+                  "this set_value_range overload expects a matrix!");
+    assert(index < get<value>(node).size());
+    assert(size_t(std::distance(first, last)) == get<value>(node)[index].size());
+    std::copy(first, last, get<value>(node)[index].begin());
 }
@@ -27,6 +27,8 @@ license and that you accept its terms.*/
 #pragma once
 
 #include <assert.h>
+#include <array>
+#include <type_traits>
 #include <vector>
 #include "Proxy.hpp"
 #include "tagged_tuple/src/tagged_tuple.hpp"
@@ -38,135 +40,244 @@ license and that you accept its terms.*/
 template <class T>
 struct ret {};
 
+// value a param reads from (used to derive Markov blankets, see markov_blanket.hpp); same_indices
+// is set if the value is indexed like the elements of the node (e.g., the allocation of a mixture)
+struct param_source {
+    const void* address;
+    bool same_indices;
+};
+
+// param function that declares which indices it depends on (bit k of Mask is set if it uses its
+// k-th index), so that traversals can evaluate it once for all the elements that share a value
+template <size_t Mask, class F>
+struct IndexedParam {
+    F f;
+    // values the param reads from, if any
+    std::array<param_source, 2> sources;
+
+    template <class... Indices>
+    decltype(auto) operator()(Indices... is) const {
+        return f(is...);
+    }
+};
+
+template <size_t Mask, class F>
+auto indexed_param(F f, std::array<param_source, 2> sources = {}) {
+    return IndexedParam<Mask, F>{f, sources};
+}
+
+// how a bound param reads its value at the indices of the element
+namespace param_access {
+    struct whole {
+        template <class V, class... Indices>
+        const V& operator()(const V& v, Indices...) const {
+            return v;
+        }
+    };
+
+    struct first_index {
+        template <class V, class I, class... Indices>
+        decltype(auto) operator()(const V& v, I i, Indices...) const {
+            return v[i];
+        }
+    };
+
+    struct second_index {
+        template <class V, class I, class J>
+        decltype(auto) operator()(const V& v, I, J j) const {
+            return v[j];
+        }
+    };
+
+    struct both_indices {
+        template <class V, class I, class J>
+        decltype(auto) operator()(const V& v, I i, J j) const {
+            return v[i][j];
+        }
+    };
+}  // namespace param_access
+
+// param reading a value (typically that of a node) through a pointer instead of a captured
+// reference, so that it can be rebound to the corresponding value of a cloned model (see clone.hpp)
+template <size_t Mask, class Value, class Access>
+struct BoundParam {
+    const Value* source;
+
+    template <class... Indices>
+    decltype(auto) operator()(Indices... is) const {
+        return Access()(*source, is...);
+    }
+};
+
+template <size_t Mask, class Access, class Value>
+auto bound_param(const Value& value) {
+    return BoundParam<Mask, Value, Access>{&value};
+}
+
+// mixture param reading array[alloc[site]], where site is the last index of the element, through
+// pointers so that both can be rebound like BoundParam (see n_to_mix and mn_to_mixn)
+template <size_t Mask, class Array, class Alloc>
+struct MixtureParam {
+    const Array* array;
+    const Alloc* alloc;
+
+    decltype(auto) operator()(int site) const { return (*array)[(*alloc)[site]]; }
+
+    decltype(auto) operator()(int, int site) const { return (*array)[(*alloc)[site]]; }
+};
+
+// other param functions (e.g., user lambdas) may depend on all indices
+template <class F>
+struct param_index_mask : std::integral_constant<size_t, ~size_t(0)> {};
+
+template <size_t Mask, class F>
+struct param_index_mask<IndexedParam<Mask, F>> : std::integral_constant<size_t, Mask> {};
+
+template <size_t Mask, class Value, class Access>
+struct param_index_mask<BoundParam<Mask, Value, Access>> : std::integral_constant<size_t, Mask> {};
+
+template <size_t Mask, class Array, class Alloc>
+struct param_index_mask<MixtureParam<Mask, Array, Alloc>> : std::integral_constant<size_t, Mask> {};
+
 // forward declarations
 namespace overloads {
     template <class Node, class Return>
     auto one_to_one(node_tag, ret<Return>, Node& node) {
-        return [&rv = raw_value(node)]() { return rv; };
+        return bound_param<0, param_access::whole>(raw_value(node));
     }
 
     template <class Node, class Return>
     auto n_to_one(node_tag, ret<Return>, Node& node) {
-        return [&rv = raw_value(node)](int) { return rv; };
+        return bound_param<0, param_access::whole>(raw_value(node));
     }
 
     template <class Node, class Return>
     auto mn_to_one(node_tag, ret<Return>, Node& node) {
-        return [&rv = raw_value(node)](int, int) { return rv; };
+        return bound_param<0, param_access::whole>(raw_value(node));
     }
 
     template <class Node, class Return>
     auto mn_to_m(node_tag, ret<Return>, Node& node) {
-        return [&rv = get<value>(node)](int i, int) { return rv[i]; };
+        return bound_param<1, param_access::first_index>(get<value>(node));
     }
 
     template <class Node, class Return>
     auto mn_to_n(node_tag, ret<Return>, Node& node) {
-        return [&rv = get<value>(node)](int, int j) { return rv[j]; };
+        return bound_param<2, param_access::second_index>(get<value>(node));
+    }
+
+    template <class Node, class Return>
+    auto mn_to_mn(node_tag, ret<Return>, Node& node) {
+        return bound_param<3, param_access::both_indices>(get<value>(node));
     }
 
     template <class Node, class Return>
     auto mnp_to_one(node_tag, ret<Return>, Node& node) {
-        return [&rv = raw_value(node)](int, int, int) { return rv; };
+        return bound_param<0, param_access::whole>(raw_value(node));
     }
 
     /*
     template <class Node, class Return>
     auto mnp_to_m(node_tag, ret<Return>, Node& node) {
-        return [&rv = raw_value(node)](int i, int, int) { return rv[i]; };
+        return indexed_param<1>([&rv = raw_value(node)](int i, int, int) { return rv[i]; });
     }
     */
 
     template <class Node, class Return>
     auto n_to_n(node_tag, ret<Return>, Node& node) {
-        return [&v = get<value>(node)](int i) { return v[i]; };
+        return bound_param<1, param_access::first_index>(get<value>(node));
     }
 
     template <class Dnode, class Return>
     auto one_to_one(dnode_tag, ret<Return>, Dnode& dnode) {
-        return [&rv = raw_value(dnode)]() { return rv; };
+        return bound_param<0, param_access::whole>(raw_value(dnode));
     }
 
     template <class Dnode, class Return>
     auto n_to_one(dnode_tag, ret<Return>, Dnode& dnode) {
-        return [&rv = raw_value(dnode)](int) { return rv; };
+        return bound_param<0, param_access::whole>(raw_value(dnode));
     }
 
     template <class Dnode, class Return>
     auto mn_to_one(dnode_tag, ret<Return>, Dnode& dnode) {
-        return [&rv = raw_value(dnode)](int, int) { return rv; };
+        return bound_param<0, param_access::whole>(raw_value(dnode));
     }
 
     template <class Dnode, class Return>
     auto mn_to_m(dnode_tag, ret<Return>, Dnode& dnode) {
-        return [&rv = get<value>(dnode)](int i, int) { return rv[i]; };
+        return bound_param<1, param_access::first_index>(get<value>(dnode));
     }
 
     template <class Dnode, class Return>
     auto mn_to_n(dnode_tag, ret<Return>, Dnode& dnode) {
-        return [&rv = get<value>(dnode)](int, int j) { return rv[j]; };
+        return bound_param<2, param_access::second_index>(get<value>(dnode));
+    }
+
+    template <class Dnode, class Return>
+    auto mn_to_mn(dnode_tag, ret<Return>, Dnode& dnode) {
+        return bound_param<3, param_access::both_indices>(get<value>(dnode));
     }
 
     template <class Dnode, class Return>
     auto n_to_n(dnode_tag, ret<Return>, Dnode& dnode) {
-        return [&v = get<value>(dnode)](int i) { return v[i]; };
+        return bound_param<1, param_access::first_index>(get<value>(dnode));
     }
 
     template <class Unknown, class Return>
     auto one_to_one(unknown_tag, ret<Return>, Unknown& u) {
-        return [&u]() -> const Return& { return u; };
+        return bound_param<0, param_access::whole, Return>(u);
     }
 
     template <class Unknown, class Return>
     auto n_to_one(unknown_tag, ret<Return>, Unknown& u) {
-        return [&u](int) -> const Return& { return u; };
+        return bound_param<0, param_access::whole, Return>(u);
     }
 
     template <class Unknown, class Return>
     auto mn_to_one(unknown_tag, ret<Return>, Unknown& u) {
-        return [&u](int, int) -> const Return& { return u; };
+        return bound_param<0, param_access::whole, Return>(u);
     }
 
 }  // namespace overloads
 
 template <class Unknown, class Return = Unknown>
 auto mn_to_m(std::vector<Unknown>& u) {
-    return [&u](int i, int) -> const Return& { return u[i]; };
+    return bound_param<1, param_access::first_index>(u);
 }
 
 template <class Unknown, class Return = Unknown>
 auto mn_to_n(std::vector<Unknown>& u) {
-    return [&u](int, int j) -> const Return& { return u[j]; };
+    return bound_param<2, param_access::second_index>(u);
 }
 
 template <class Unknown, class Return = Unknown>
 auto n_to_n(std::vector<Unknown>& u) {
-    return [&u](int i) -> const Return& { return u[i]; };
+    return bound_param<1, param_access::first_index>(u);
 }
 
 template <class Unknown, class Return = Unknown>
 auto n_to_one(Proxy<Unknown>& u) {
-    return [&u](int) -> const Return& { return u.get(); };
+    return indexed_param<0>([&u](int) -> const Return& { return u.get(); });
 }
 
 template <class Unknown, class Return = Unknown>
 auto mn_to_one(Proxy<Unknown>& u) {
-    return [&u](int, int) -> const Return& { return u.get(); };
+    return indexed_param<0>([&u](int, int) -> const Return& { return u.get(); });
 }
 
 template <class Unknown, class Return = Unknown>
 auto mn_to_m(Proxy<Unknown, int>& u) {
-    return [&u](int i, int) -> const Return& { return u.get(i); };
+    return indexed_param<1>([&u](int i, int) -> const Return& { return u.get(i); });
 }
 
 template <class Unknown, class Return = Unknown>
 auto mn_to_n(Proxy<Unknown, int>& u) {
-    return [&u](int, int j) -> const Return& { return u.get(j); };
+    return indexed_param<2>([&u](int, int j) -> const Return& { return u.get(j); });
 }
 
 template <class Unknown, class Return = Unknown>
 auto n_to_n(Proxy<Unknown, int>& u) {
-    return [&u](int i) -> const Return& { return u.get(i); };
+    return indexed_param<1>([&u](int i) -> const Return& { return u.get(i); });
 }
 
 template <class T, class Return = T>
@@ -194,6 +305,11 @@ auto mn_to_n(T& t) {
     return overloads::mn_to_n(type_tag(t), ret<Return>{}, t);
 }
 
+template <class T, class Return = T>
+auto mn_to_mn(T& t) {
+    return overloads::mn_to_mn(type_tag(t), ret<Return>{}, t);
+}
+
 template <class T, class Return = T>
 auto n_to_n(T& t) {
     return overloads::n_to_n(type_tag(t), ret<Return>{}, t);
@@ -201,27 +317,27 @@ auto n_to_n(T& t) {
 
 template <class T, class Return = T>
 auto one_to_const(const T& value) {
-    return [value]() -> const Return& { return value; };
+    return indexed_param<0>([value]() -> const Return& { return value; });
 }
 
 template <class T, class Return = T>
 auto n_to_const(const T& value) {
-    return [value](int) -> const Return& { return value; };
+    return indexed_param<0>([value](int) -> const Return& { return value; });
 }
 
 template <class T, class Return = T>
 auto mn_to_const(const T& value) {
-    return [value](int, int) -> const Return& { return value; };
+    return indexed_param<0>([value](int, int) -> const Return& { return value; });
 }
 
 template<class Array, class Alloc>
 auto n_to_mix(Array& array, Alloc& alloc)  {
-    return [&array, &alloc] (int site) {return array[alloc[site]];};
+    return MixtureParam<1, Array, Alloc>{&array, &alloc};
 }
 
 template<class Array, class Alloc>
 auto mn_to_mixn(Array& array, Alloc& alloc)  {
-    return [&array, &alloc] (int branch, int site) {return array[alloc[site]];};
+    return MixtureParam<2, Array, Alloc>{&array, &alloc};
 }
 
 
@@ -0,0 +1,183 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <assert.h>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "array_utils.hpp"
+#include "introspection.hpp"
+#include "type_tag.hpp"
+
+/*==================================================================================================
+~~ Cloning models ~~
+Node values live behind unique pointers, so moving a model around does not invalidate its params.
+clone_model(m) copies the values and params of all the nodes of m, then rebinds the params that
+read a node of m (BoundParams and MixtureParams, built by the factories of array_utils.hpp) to the
+corresponding node of the clone. Params given as user lambdas cannot be rebound and do not compile
+here; params wrapped with indexed_param must not read nodes of m (checked in debug builds).
+Observed nodes built with make_observed_node(_array/_matrix) or make_compressed_node_(array/matrix)
+share their data with their clones.
+==================================================================================================*/
+
+namespace clone_utils {
+    // (original value, cloned value) pairs
+    using address_map = std::vector<std::pair<const void*, const void*>>;
+
+    template <class T>
+    void rebind_pointer(const T*& ptr, const address_map& map) {
+        for (auto& p : map) {
+            if (p.first == ptr) {
+                ptr = static_cast<const T*>(p.second);
+                return;
+            }
+        }
+    }
+
+    // user lambdas may capture references to the original model, which cannot be rebound
+    template <class Param>
+    void rebind(Param&, const address_map&) {
+        static_assert(sizeof(Param) == 0,
+                      "in clone_model: param cannot be rebound, build it with the factories of "
+                      "array_utils.hpp");
+    }
+
+    // constants and values outside of the model (e.g., proxies) are shared with the clone
+    template <size_t Mask, class F>
+    void rebind(IndexedParam<Mask, F>& param, const address_map& map) {
+        for (auto& source : param.sources) {
+            for (auto& p : map) {
+                assert(p.first != source.address && "in clone_model: param cannot be rebound");
+                (void)p;
+            }
+        }
+    }
+
+    template <size_t Mask, class Value, class Access>
+    void rebind(BoundParam<Mask, Value, Access>& param, const address_map& map) {
+        rebind_pointer(param.source, map);
+    }
+
+    template <size_t Mask, class Array, class Alloc>
+    void rebind(MixtureParam<Mask, Array, Alloc>& param, const address_map& map) {
+        rebind_pointer(param.array, map);
+        rebind_pointer(param.alloc, map);
+    }
+
+    template <class Node, class... Keys>
+    void rebind_params(Node& node, const address_map& map, std::tuple<Keys...>) {
+        int unused[] = {0, (rebind(get<params, Keys>(node), map), 0)...};
+        (void)unused;
+    }
+
+    template <class Node>
+    auto clone_node(std::false_type /* owns its value */, Node& node) {
+        auto v = get<value>(node);
+        return make_tagged_tuple<metadata_t<Node>>(unique_ptr_field<struct value>(std::move(v)),
+                                                   value_field<struct params>(get<params>(node)));
+    }
+
+    // observed data is shared with the clone
+    template <class Node>
+    auto clone_node(std::true_type /* shares its value */, Node& node) {
+        return make_tagged_tuple<metadata_t<Node>>(
+            ref_field<struct value>(get<value>(node)),
+            value_field<struct shared_data>(get<shared_data>(node)),
+            value_field<struct params>(get<params>(node)));
+    }
+
+    template <class Node>
+    auto clone_field(node_tag, Node& node) {
+        return clone_node(has_shared_data<Node>(), node);
+    }
+
+    template <class Dnode>
+    auto clone_field(dnode_tag, Dnode& dnode) {
+        auto v = get<value>(dnode);
+        return make_tagged_tuple<metadata_t<Dnode>>(unique_ptr_field<struct value>(std::move(v)),
+                                                    value_field<struct params>(get<params>(dnode)));
+    }
+
+    // tree processes have a different layout
+    template <class Node>
+    auto clone_field(node_tree_process_tag, Node& node) = delete;
+
+    template <class Node>
+    auto clone_field(node_cond_tree_process_tag, Node& node) = delete;
+
+    template <class Node>
+    void register_field(node_tag, Node& from, Node& to, address_map& map) {
+        map.emplace_back(&get<value>(from), &get<value>(to));
+    }
+
+    template <class Dnode>
+    void register_field(dnode_tag, Dnode& from, Dnode& to, address_map& map) {
+        map.emplace_back(&get<value>(from), &get<value>(to));
+    }
+
+    template <class Node>
+    void rebind_field(node_tag, Node& node, const address_map& map) {
+        rebind_params(node, map, param_keys_t<node_distrib_t<Node>>());
+    }
+
+    template <class Dnode>
+    void rebind_field(dnode_tag, Dnode& dnode, const address_map& map) {
+        rebind_params(dnode, map, param_keys_t<dnode_distrib_t<Dnode>>());
+    }
+
+    template <class M, class... Fields>
+    auto clone_model(M& m, std::tuple<Fields...>) {
+        auto clone = make_tagged_tuple<metadata_t<M>>(
+            move_field<Fields>(clone_field(type_tag(get<Fields>(m)), get<Fields>(m)))...);
+        address_map map;
+        int unused[] = {
+            0, (register_field(type_tag(get<Fields>(m)), get<Fields>(m), get<Fields>(clone), map),
+                0)...};
+        int unused2[] = {
+            0, (rebind_field(type_tag(get<Fields>(clone)), get<Fields>(clone), map), 0)...};
+        (void)unused;
+        (void)unused2;
+        return clone;
+    }
+}  // namespace clone_utils
+
+// deep copy of a model whose params read the nodes of the copy
+template <class M>
+auto clone_model(M& m) {
+    return clone_utils::clone_model(m, model_nodes<M>());
+}
+
+// same as make_model_array, with copies of a model instead of calls to its constructor
+template <class M>
+auto clone_model_array(size_t size, M& m) {
+    auto vec = std::make_unique<std::vector<M>>();
+    vec->reserve(size);
+    for (size_t i = 0; i < size; i++) { vec->push_back(clone_model(m)); }
+    return vec;
+}
@@ -32,3 +32,4 @@ license and that you accept its terms.*/
 #include "params.hpp"
 #include "tagged_tuple/src/tagged_tuple.hpp"
 #include "utils/random.hpp"
+#include "utils/samplers.hpp"
@@ -29,6 +29,7 @@ license and that you accept its terms.*/
 #include <vector>
 #include "datatypes.hpp"
 #include "params.hpp"
+#include "utils/arena.hpp"
 
 template <class Tag, class Distrib>
 using dnode_metadata = metadata<type_list<dnode_tag, Tag>, type_map<property<distrib, Distrib>>>;
@@ -101,3 +102,27 @@ auto make_dnode_cubix_with_init(size_t size_x, size_t size_y, size_t size_z, typ
         unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
 }
 
+
+// dnode arrays and matrices whose values are allocated in an arena (see make_arena_node_array)
+template <class Distrib, class... ParamArgs>
+auto make_arena_dnode_array(std::shared_ptr<Arena> arena, size_t size, ParamArgs&&... args) {
+    using T = typename Distrib::T;
+    arena_vector<T> values(size, T(), ArenaAllocator<T>(arena));
+    auto params = make_array_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<dnode_metadata<dnode_array_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
+}
+
+template <class Distrib, class... ParamArgs>
+auto make_arena_dnode_matrix(std::shared_ptr<Arena> arena, size_t size_x, size_t size_y,
+                             ParamArgs&&... args) {
+    using T = typename Distrib::T;
+    arena_matrix<T> values(ArenaAllocator<arena_vector<T>>{arena});
+    values.reserve(size_x);
+    for (size_t i = 0; i < size_x; i++) {
+        values.emplace_back(size_y, T(), ArenaAllocator<T>(arena));
+    }
+    auto params = make_matrix_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<dnode_metadata<dnode_matrix_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
+}
@@ -0,0 +1,124 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <array>
+#include <type_traits>
+#include <utility>
+#include "array_utils.hpp"
+#include "introspection.hpp"
+
+/*==================================================================================================
+~~ Hoisting of loop-invariant params ~~
+Param functions built with the factories of array_utils.hpp declare the indices they depend on.
+When traversing an array, matrix or cubix, params are then transformed (e.g., log(rate) computed)
+only when one of these indices changes: once per row for mn_to_m params, once per traversal for
+n_to_one or n_to_const params. Other param functions are re-evaluated for each element.
+==================================================================================================*/
+constexpr size_t bit_or() { return 0; }
+
+template <class... Rest>
+constexpr size_t bit_or(size_t first, Rest... rest) {
+    return first | bit_or(rest...);
+}
+
+template <class Node, class Keys>
+struct node_param_index_mask;
+
+template <class Node, class... Keys>
+struct node_param_index_mask<Node, std::tuple<Keys...>>
+    : std::integral_constant<size_t,
+                             bit_or(param_index_mask<std::decay_t<decltype(
+                                        get<params, Keys>(std::declval<Node&>()))>>::value...)> {
+};
+
+template <class Tag>
+struct nb_indices : std::integral_constant<size_t, 0> {};
+
+template <>
+struct nb_indices<node_array_tag> : std::integral_constant<size_t, 1> {};
+
+template <>
+struct nb_indices<node_matrix_tag> : std::integral_constant<size_t, 2> {};
+
+template <>
+struct nb_indices<node_cubix_tag> : std::integral_constant<size_t, 3> {};
+
+template <>
+struct nb_indices<node_sparse_matrix_tag> : std::integral_constant<size_t, 2> {};
+
+template <>
+struct nb_indices<dnode_array_tag> : std::integral_constant<size_t, 1> {};
+
+template <>
+struct nb_indices<dnode_matrix_tag> : std::integral_constant<size_t, 2> {};
+
+template <>
+struct nb_indices<dnode_cubix_tag> : std::integral_constant<size_t, 3> {};
+
+// transformed params of the last element, reused as long as the indices in Mask do not change
+template <size_t Mask, size_t N, class Transformed>
+class HoistedParams {
+  public:
+    static constexpr size_t mask = Mask;
+
+  private:
+    bool _valid{false};
+    std::array<size_t, N> _key;
+    Transformed _transformed;
+
+  public:
+    template <class Compute, class... Indices>
+    const Transformed& transformed(Compute compute, Indices... is) {
+        std::array<size_t, N> key{{size_t(is)...}};
+        for (size_t d = 0; d < N; d++) {
+            if (!((Mask >> d) & 1)) { key[d] = 0; }
+        }
+        if (!_valid || key != _key) {
+            _transformed = compute();
+            _key = key;
+            _valid = true;
+        }
+        return _transformed;
+    }
+};
+
+template <class Node, class Transform, class... Keys, size_t... Is>
+auto hoisted_transform_type(Node& node, Transform& transform, std::tuple<Keys...>,
+                            std::index_sequence<Is...>)
+    -> decltype(transform(node_distrib_t<Node>{}, get<params, Keys>(node)((void(Is), 0)...)...));
+
+// transform(distrib, params...) computes the transformed params of one element
+template <class Node, class Transform>
+auto make_hoisted_params(Node& node, Transform& transform) {
+    using keys = param_keys_t<node_distrib_t<Node>>;
+    using indices = nb_indices<decltype(type_tag(node))>;
+    using transformed = decltype(hoisted_transform_type(node, transform, keys(),
+                                                        std::make_index_sequence<indices::value>()));
+    return HoistedParams<node_param_index_mask<Node, keys>::value, indices::value, transformed>();
+}
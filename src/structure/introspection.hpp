@@ -70,6 +70,17 @@ using is_node_matrix = has_meta_tag<T, node_matrix_tag>;
 template <class T>
 using is_node_cubix = has_meta_tag<T, node_cubix_tag>;
 
+template <class T>
+using is_node_sparse_matrix = has_meta_tag<T, node_sparse_matrix_tag>;
+
+// nodes reading read-only data shared with other models (see make_observed_node)
+template <class T>
+using has_shared_data = has_meta_tag<T, shared_data_tag>;
+
+// observed nodes storing unique patterns with their counts (see make_compressed_node_array)
+template <class T>
+using has_pattern_counts = has_meta_tag<T, pattern_counts_tag>;
+
 template <class T>
 using is_lone_dnode = has_meta_tag<T, lone_dnode_tag>;
 
@@ -94,13 +105,37 @@ struct has_array_logprob : std::false_type {};
 template <class T>
 struct has_array_logprob<T, to_void<decltype(T::array_logprob)>> : std::true_type {};
 
+// data_logprob(x) is the part of logprob that depends only on x, and param_logprob(x, params...)
+// the rest
 template <class T, class = void>
-struct has_array_draw : std::false_type {};
+struct has_data_logprob : std::false_type {};
 
 template <class T>
-struct has_array_draw<T, to_void<decltype(T::template array_draw<decltype(make_generator())>)>>
+struct has_data_logprob<T, to_void<decltype(T::data_logprob)>> : std::true_type {};
+
+// array_draw(values, param_fns..., gen) draws a whole array, with param_fns(i) the parameters of
+// element i (as in node arrays)
+struct param_fn_probe {
+    double operator()(size_t) const { return 0; }
+};
+
+template <class>
+using param_fn_probe_for = param_fn_probe;
+
+template <class T, class ParamKeys, class = void>
+struct has_array_draw_helper : std::false_type {};
+
+template <class T, class... Keys>
+struct has_array_draw_helper<
+    T, std::tuple<Keys...>,
+    to_void<decltype(T::array_draw(std::declval<std::vector<typename T::T>&>(),
+                                   param_fn_probe_for<Keys>()...,
+                                   std::declval<decltype(make_generator())&>()))>>
     : std::true_type {};
 
+template <class T>
+struct has_array_draw : has_array_draw_helper<T, map_key_list_t<typename T::param_decl>> {};
+
 //==================================================================================================
 // node introspection
 
@@ -113,6 +148,26 @@ using node_root_distrib_t = metadata_get_property<struct root_distrib, metadata_
 template <class Distrib>
 using param_keys_t = map_key_list_t<typename Distrib::param_decl>;
 
+// position of Key in a list of param keys, starting at 1 (-1 if absent)
+template <class Key, class Keys>
+struct param_position : std::integral_constant<int, -1> {};
+
+template <class Key, class... Keys>
+struct param_position<Key, std::tuple<Key, Keys...>> : std::integral_constant<int, 1> {};
+
+template <class Key, class First, class... Keys>
+struct param_position<Key, std::tuple<First, Keys...>>
+    : std::integral_constant<int, param_position<Key, std::tuple<Keys...>>::value < 0
+                                      ? -1
+                                      : 1 + param_position<Key, std::tuple<Keys...>>::value> {};
+
+// role of a node in a logprob term: 0 for its value, i for its i-th param (-1 if unrelated)
+template <class Distrib, class Role>
+struct role_index
+    : std::integral_constant<int, std::is_same<Role, value>::value
+                                      ? 0
+                                      : param_position<Role, param_keys_t<Distrib>>::value> {};
+
 //==================================================================================================
 // dnode introspection
 
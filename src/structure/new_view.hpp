@@ -25,6 +25,9 @@ The fact that you are presently reading this means that you have had knowledge o
 license and that you accept its terms.*/
 
 #pragma once
+
+#include <vector>
+#include "hoisting.hpp"
 #include "introspection.hpp"
 #include "operations/raw_value.hpp"
 
@@ -38,11 +41,165 @@ auto apply(UseNodeContext<F, type_list<Keys...>> cf, Node& node, Indices... is)
     cf.f(node_distrib_t<Node>{}, raw_value(node, is...), get<params, Keys>(node)(is...)...);
 }
 
+// same as UseNodeContext, with params transformed by transform(distrib, params...) and hoisted out
+// of the loops when possible (see hoisting.hpp); calls f(distrib, value, transformed)
+template <class Hoisted, class Transform, class F, class KeyList>
+struct UseHoistedNodeContext {
+    Hoisted* hoisted;
+    Transform transform;
+    F f;
+};
+
+template <class Hoisted, class Transform, class F, class... Keys, class Node, class... Indices>
+auto apply(UseHoistedNodeContext<Hoisted, Transform, F, type_list<Keys...>> cf, Node& node,
+           Indices... is) {
+    using distrib = node_distrib_t<Node>;
+    auto& transformed = cf.hoisted->transformed(
+        [&]() { return cf.transform(distrib{}, get<params, Keys>(node)(is...)...); }, is...);
+    cf.f(distrib{}, raw_value(node, is...), transformed);
+}
+
 template <class F, class Node, class... Indices>
 auto apply(F f, Node& node, Indices... is) {
     f(raw_value(node, is...));
 }
 
+// multiplicity of the element (or row) at the given indices: pattern counts of compressed nodes
+// (see make_compressed_node_array), 1 otherwise
+template <class Node, class... Indices>
+double pattern_weight(std::false_type, Node&, Indices...) {
+    return 1;
+}
+
+template <class Node, class... Indices>
+double pattern_weight(std::true_type, Node& node, size_t i, Indices...) {
+    return get<shared_data>(node)->counts[i];
+}
+
+// same as UseHoistedNodeContext, for across_nodes_weighted; calls f(distrib, value, transformed,
+// weight)
+template <class Hoisted, class Transform, class F, class KeyList>
+struct UseWeightedNodeContext {
+    Hoisted* hoisted;
+    Transform transform;
+    F f;
+};
+
+template <class Hoisted, class Transform, class F, class... Keys, class Node, class... Indices>
+auto apply(UseWeightedNodeContext<Hoisted, Transform, F, type_list<Keys...>> cf, Node& node,
+           Indices... is) {
+    using distrib = node_distrib_t<Node>;
+    auto& transformed = cf.hoisted->transformed(
+        [&]() { return cf.transform(distrib{}, get<params, Keys>(node)(is...)...); }, is...);
+    cf.f(distrib{}, raw_value(node, is...), transformed,
+         pattern_weight(has_pattern_counts<Node>(), node, is...));
+}
+
+/*==================================================================================================
+~~ Blocks of sparse matrices ~~
+apply_block(f, node, r0, r1, c0, c1) applies f to the cells in rows [r0, r1) and columns [c0, c1)
+of a sparse matrix node. Values are passed as const copies, including the zeros that are not
+stored (so writing through f does not compile), except with UseWeightedNodeContext where only
+nonzero entries are visited individually.
+==================================================================================================*/
+template <class F, class... Keys, class Node, class T, class... Indices>
+void apply_value(UseNodeContext<F, type_list<Keys...>> cf, Node& node, T& x, Indices... is) {
+    cf.f(node_distrib_t<Node>{}, x, get<params, Keys>(node)(is...)...);
+}
+
+template <class Hoisted, class Transform, class F, class... Keys, class Node, class T,
+          class... Indices>
+void apply_value(UseHoistedNodeContext<Hoisted, Transform, F, type_list<Keys...>> cf, Node& node,
+                 T& x, Indices... is) {
+    using distrib = node_distrib_t<Node>;
+    auto& transformed = cf.hoisted->transformed(
+        [&]() { return cf.transform(distrib{}, get<params, Keys>(node)(is...)...); }, is...);
+    cf.f(distrib{}, x, transformed);
+}
+
+template <class F, class Node, class T, class... Indices>
+void apply_value(F f, Node&, T& x, Indices...) {
+    f(x);
+}
+
+template <class F, class Node>
+void apply_block(F f, Node& node, size_t r0, size_t r1, size_t c0, size_t c1) {
+    auto& data = get<value>(node);
+    for (size_t i = r0; i < r1; i++) {
+        for (size_t j = c0; j < c1; j++) {
+            const auto x = data(i, j);
+            apply_value(f, node, x, i, j);
+        }
+    }
+}
+
+// zero entries are passed once per distinct value of the transformed params, weighted by their
+// number: once per row if params depend only on the row index, once for the block if they depend
+// on no index, etc.; nonzero entries are passed with weight 1 (zeros are never added then
+// subtracted, as their logprob may be -inf)
+template <class Hoisted, class Transform, class F, class... Keys, class Node>
+void apply_block(UseWeightedNodeContext<Hoisted, Transform, F, type_list<Keys...>> cf, Node& node,
+                 size_t r0, size_t r1, size_t c0, size_t c1) {
+    using distrib = node_distrib_t<Node>;
+    auto transformed = [&cf, &node](size_t i, size_t j) -> const auto& {
+        return cf.hoisted->transformed(
+            [&]() { return cf.transform(distrib{}, get<params, Keys>(node)(i, j)...); }, i, j);
+    };
+    if (r0 >= r1 or c0 >= c1) { return; }
+    constexpr bool by_row = Hoisted::mask & 1;
+    constexpr bool by_col = (Hoisted::mask >> 1) & 1;
+    size_t nb_group_rows = by_row ? r1 - r0 : 1, nb_group_cols = by_col ? c1 - c0 : 1;
+    auto group = [&](size_t i, size_t j) {
+        return (by_row ? i - r0 : 0) * nb_group_cols + (by_col ? j - c0 : 0);
+    };
+    auto& data = get<value>(node);
+    std::vector<size_t> nnz(nb_group_rows * nb_group_cols, 0);
+    data.across_entries(r0, r1, c0, c1, [&](size_t i, size_t j, auto) { nnz[group(i, j)]++; });
+
+    size_t cells = (by_row ? 1 : r1 - r0) * (by_col ? 1 : c1 - c0);
+    const typename distrib::T zero(0);
+    for (size_t i = r0; i < (by_row ? r1 : r0 + 1); i++) {
+        for (size_t j = c0; j < (by_col ? c1 : c0 + 1); j++) {
+            size_t nb_zeros = cells - nnz[group(i, j)];
+            if (nb_zeros > 0) { cf.f(distrib{}, zero, transformed(i, j), double(nb_zeros)); }
+        }
+    }
+    data.across_entries(r0, r1, c0, c1, [&](size_t i, size_t j, const auto x) {
+        cf.f(distrib{}, x, transformed(i, j), 1.0);
+    });
+}
+
+// rows, columns and elements of matrices
+template <class Tag, class F, class Node>
+void apply_row(Tag, F f, Node& node, size_t i) {
+    for (size_t j = 0; j < get<value>(node)[i].size(); j++) { apply(f, node, i, j); }
+}
+
+template <class F, class Node>
+void apply_row(node_sparse_matrix_tag, F f, Node& node, size_t i) {
+    apply_block(f, node, i, i + 1, 0, get<value>(node).nb_cols);
+}
+
+template <class Tag, class F, class Node>
+void apply_column(Tag, F f, Node& node, size_t j) {
+    for (size_t i = 0; i < get<value>(node).size(); i++) { apply(f, node, i, j); }
+}
+
+template <class F, class Node>
+void apply_column(node_sparse_matrix_tag, F f, Node& node, size_t j) {
+    apply_block(f, node, 0, get<value>(node).nb_rows, j, j + 1);
+}
+
+template <class Tag, class F, class Node>
+void apply_element(Tag, F f, Node& node, size_t i, size_t j) {
+    apply(f, node, i, j);
+}
+
+template <class F, class Node>
+void apply_element(node_sparse_matrix_tag, F f, Node& node, size_t i, size_t j) {
+    apply_block(f, node, i, i + 1, j, j + 1);
+}
+
 /*==================================================================================================
 ~~ Node subset ~~
 ==================================================================================================*/
@@ -63,6 +220,22 @@ class NodeSubset {
     void across_nodes(F f) {
         subset(node, UseNodeContext<F, param_keys_t<node_distrib_t<Node>>>{f});
     }
+
+    template <class Transform, class F>
+    void across_nodes_hoisted(Transform transform, F f) {
+        auto hoisted = make_hoisted_params(node, transform);
+        using context = UseHoistedNodeContext<decltype(hoisted), Transform, F,
+                                              param_keys_t<node_distrib_t<Node>>>;
+        subset(node, context{&hoisted, transform, f});
+    }
+
+    template <class Transform, class F>
+    void across_nodes_weighted(Transform transform, F f) {
+        auto hoisted = make_hoisted_params(node, transform);
+        using context = UseWeightedNodeContext<decltype(hoisted), Transform, F,
+                                               param_keys_t<node_distrib_t<Node>>>;
+        subset(node, context{&hoisted, transform, f});
+    }
 };
 
 template <class Node, class Subset>
@@ -85,13 +258,24 @@ struct subsets {
         });
     }
 
+    template <class Node>
+    static auto range(Node& node, size_t begin, size_t end) {
+        return make_subset(node, [begin, end](auto& node, auto f) {
+            static_assert(is_node_array<std::decay_t<decltype(node)>>::value
+                    || is_dnode_array<std::decay_t<decltype(node)>>::value,
+                          "Expects a node or dnode array");
+            for (size_t i = begin; i < end; i++) { apply(f, node, i); }
+        });
+    }
+
     template <class Node>
     static auto element(Node& node, size_t i, size_t j) {
         return make_subset(node, [i, j](auto& node, auto f) {
             static_assert(is_node_matrix<std::decay_t<decltype(node)>>::value
-                    || is_dnode_matrix<std::decay_t<decltype(node)>>::value,
+                    || is_dnode_matrix<std::decay_t<decltype(node)>>::value
+                    || is_node_sparse_matrix<std::decay_t<decltype(node)>>::value,
                           "Expects a node or dnode matrix");
-            apply(f, node, i, j);
+            apply_element(type_tag(node), f, node, i, j);
         });
     }
 
@@ -99,9 +283,10 @@ struct subsets {
     static auto row(Node& node, size_t i) {
         return make_subset(node, [i](auto& node, auto f) {
             static_assert(is_node_matrix<std::decay_t<decltype(node)>>::value
-                    || is_dnode_matrix<std::decay_t<decltype(node)>>::value,
+                    || is_dnode_matrix<std::decay_t<decltype(node)>>::value
+                    || is_node_sparse_matrix<std::decay_t<decltype(node)>>::value,
                           "Expects a node or dnode matrix");
-            for (size_t j = 0; j < get<value>(node)[i].size(); j++) { apply(f, node, i, j); }
+            apply_row(type_tag(node), f, node, i);
         });
     }
 
@@ -109,9 +294,10 @@ struct subsets {
     static auto column(Node& node, size_t j) {
         return make_subset(node, [j](auto& node, auto f) {
             static_assert(is_node_matrix<std::decay_t<decltype(node)>>::value
-                    || is_dnode_matrix<std::decay_t<decltype(node)>>::value,
+                    || is_dnode_matrix<std::decay_t<decltype(node)>>::value
+                    || is_node_sparse_matrix<std::decay_t<decltype(node)>>::value,
                           "Expects a node or dnode matrix");
-            for (size_t i = 0; i < get<value>(node).size(); i++) { apply(f, node, i, j); }
+            apply_column(type_tag(node), f, node, j);
         });
     }
 
@@ -26,9 +26,16 @@ license and that you accept its terms.*/
 
 #pragma once
 
+#include <memory>
+#include <type_traits>
 #include <vector>
 #include "datatypes.hpp"
+#include "hoisting.hpp"
 #include "params.hpp"
+#include "patterns.hpp"
+#include "ragged.hpp"
+#include "sparse_matrix.hpp"
+#include "utils/arena.hpp"
 
 template <class Tag, class Distrib>
 using node_metadata = metadata<type_list<node_tag, Tag>, type_map<property<distrib, Distrib>>>;
@@ -101,3 +108,179 @@ auto make_node_cubix_with_init(size_t size_x, size_t size_y, size_t size_z, type
         unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
 }
 
+//==================================================================================================
+// nodes whose values are stored as Storage instead of Distrib::T, e.g. uint8_t for bernoulli or
+// small categoricals, uint32_t for counts; values are converted to Distrib::T when read and must
+// fit in Storage (checked in debug builds by draw)
+template <class Distrib, class Storage, class... ParamArgs>
+auto make_compact_node_array(size_t size, ParamArgs&&... args) {
+    static_assert(std::is_integral<Storage>::value and std::is_integral<typename Distrib::T>::value,
+                  "compact storage is meant for integer-valued nodes");
+    std::vector<Storage> values(size);
+    auto params = make_array_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<node_metadata<node_array_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
+}
+
+template <class Distrib, class Storage, class... ParamArgs>
+auto make_compact_node_matrix(size_t size_x, size_t size_y, ParamArgs&&... args) {
+    static_assert(std::is_integral<Storage>::value and std::is_integral<typename Distrib::T>::value,
+                  "compact storage is meant for integer-valued nodes");
+    matrix<Storage> values(size_x, std::vector<Storage>(size_y));
+    auto params = make_matrix_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<node_metadata<node_matrix_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
+}
+
+//==================================================================================================
+// nodes whose real values are stored with the precision given by Precision (e.g. float storage
+// for large latent or observed arrays with single_precision); kernels still compute in double
+template <class Distrib, class Precision, class... ParamArgs>
+auto make_node_array_with_precision(size_t size, ParamArgs&&... args) {
+    using Storage = typename Precision::template storage<typename Distrib::T>;
+    std::vector<Storage> values(size);
+    auto params = make_array_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<node_metadata<node_array_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
+}
+
+template <class Distrib, class Precision, class... ParamArgs>
+auto make_node_matrix_with_precision(size_t size_x, size_t size_y, ParamArgs&&... args) {
+    using Storage = typename Precision::template storage<typename Distrib::T>;
+    matrix<Storage> values(size_x, std::vector<Storage>(size_y));
+    auto params = make_matrix_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<node_metadata<node_matrix_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
+}
+
+//==================================================================================================
+// node arrays and matrices whose values are allocated in an arena (see utils/arena.hpp), e.g., so
+// that all the large arrays of a model share one region backed by huge pages
+template <class Distrib, class... ParamArgs>
+auto make_arena_node_array(std::shared_ptr<Arena> arena, size_t size, ParamArgs&&... args) {
+    using T = typename Distrib::T;
+    arena_vector<T> values(size, T(), ArenaAllocator<T>(arena));
+    auto params = make_array_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<node_metadata<node_array_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
+}
+
+template <class Distrib, class... ParamArgs>
+auto make_arena_node_matrix(std::shared_ptr<Arena> arena, size_t size_x, size_t size_y,
+                            ParamArgs&&... args) {
+    using T = typename Distrib::T;
+    arena_matrix<T> values(ArenaAllocator<arena_vector<T>>{arena});
+    values.reserve(size_x);
+    for (size_t i = 0; i < size_x; i++) {
+        values.emplace_back(size_y, T(), ArenaAllocator<T>(arena));
+    }
+    auto params = make_matrix_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<node_metadata<node_matrix_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
+}
+
+//==================================================================================================
+// array of variable-length values (e.g., ragged_dirichlet profiles), element i having sizes[i]
+// components, stored in a single buffer (see RaggedArray)
+template <class Distrib, class... ParamArgs>
+auto make_ragged_node_array(const std::vector<size_t>& sizes, ParamArgs&&... args) {
+    RaggedArray<typename Distrib::T::value_type> values(sizes);
+    auto params = make_array_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<node_metadata<node_array_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(values)), value_field<struct params>(params));
+}
+
+//==================================================================================================
+// observed matrix stored as a SparseMatrix (e.g., counts that are mostly zeros); logprob and
+// param_logprob then cost one evaluation per nonzero entry and per distinct param value (see
+// across_nodes_hoisted) instead of one per cell
+template <class Distrib, class... ParamArgs>
+auto make_sparse_node_matrix(SparseMatrix<typename Distrib::T> data, ParamArgs&&... args) {
+    auto params = make_matrix_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<node_metadata<node_sparse_matrix_tag, Distrib>>(
+        unique_ptr_field<struct value>(std::move(data)), value_field<struct params>(params));
+}
+
+//==================================================================================================
+// observed nodes whose value is a read-only buffer shared between models (e.g., between chains)
+// instead of a copy per model; writing to their value does not compile
+template <class Tag, class Distrib>
+using shared_node_metadata =
+    metadata<type_list<node_tag, Tag, shared_data_tag>, type_map<property<distrib, Distrib>>>;
+
+template <class T>
+auto make_shared_data(T&& data) {
+    return std::make_shared<const std::decay_t<T>>(std::forward<T>(data));
+}
+
+template <class Distrib, class... ParamArgs>
+auto make_observed_node(std::shared_ptr<const typename Distrib::T> data, ParamArgs&&... args) {
+    auto params = make_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<shared_node_metadata<lone_node_tag, Distrib>>(
+        ref_field<struct value>(*data), value_field<struct shared_data>(data),
+        value_field<struct params>(params));
+}
+
+// data is a std::vector or any read-only range with the same interface (e.g., map_array)
+template <class Distrib, class Data, class... ParamArgs>
+auto make_observed_node_array(std::shared_ptr<const Data> data, ParamArgs&&... args) {
+    auto params = make_array_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<shared_node_metadata<node_array_tag, Distrib>>(
+        ref_field<struct value>(*data), value_field<struct shared_data>(data),
+        value_field<struct params>(params));
+}
+
+// data is a matrix or any read-only range of rows (e.g., map_matrix)
+template <class Distrib, class Data, class... ParamArgs>
+auto make_observed_node_matrix(std::shared_ptr<const Data> data, ParamArgs&&... args) {
+    auto params = make_matrix_params<Distrib>(std::forward<ParamArgs>(args)...);
+    return make_tagged_tuple<shared_node_metadata<node_matrix_tag, Distrib>>(
+        ref_field<struct value>(*data), value_field<struct shared_data>(data),
+        value_field<struct params>(params));
+}
+
+//==================================================================================================
+// observed nodes storing each distinct element (or matrix row) once, with its count (see
+// patterns.hpp); logprob and the other *_logprob functions weight each pattern by its count. Params
+// must not depend on the index of the element (resp. row), as it is that of the pattern.
+template <class Tag, class Distrib>
+using compressed_node_metadata =
+    metadata<type_list<node_tag, Tag, shared_data_tag, pattern_counts_tag>,
+             type_map<property<distrib, Distrib>>>;
+
+template <class Distrib, class Values, class... ParamArgs>
+auto make_compressed_node_array(std::shared_ptr<const PatternData<Values>> data,
+                                ParamArgs&&... args) {
+    auto params = make_array_params<Distrib>(std::forward<ParamArgs>(args)...);
+    auto node = make_tagged_tuple<compressed_node_metadata<node_array_tag, Distrib>>(
+        ref_field<struct value>(data->values), value_field<struct shared_data>(data),
+        value_field<struct params>(params));
+    static_assert((node_param_index_mask<decltype(node), param_keys_t<Distrib>>::value & 1) == 0,
+                  "params of compressed nodes cannot depend on the element index");
+    return node;
+}
+
+template <class Distrib, class... ParamArgs>
+auto make_compressed_node_array(const std::vector<typename Distrib::T>& data,
+                                ParamArgs&&... args) {
+    return make_compressed_node_array<Distrib>(make_shared_data(compress_patterns(data)),
+                                               std::forward<ParamArgs>(args)...);
+}
+
+template <class Distrib, class Values, class... ParamArgs>
+auto make_compressed_node_matrix(std::shared_ptr<const PatternData<Values>> data,
+                                 ParamArgs&&... args) {
+    auto params = make_matrix_params<Distrib>(std::forward<ParamArgs>(args)...);
+    auto node = make_tagged_tuple<compressed_node_metadata<node_matrix_tag, Distrib>>(
+        ref_field<struct value>(data->values), value_field<struct shared_data>(data),
+        value_field<struct params>(params));
+    static_assert((node_param_index_mask<decltype(node), param_keys_t<Distrib>>::value & 1) == 0,
+                  "params of compressed nodes cannot depend on the row index");
+    return node;
+}
+
+template <class Distrib, class... ParamArgs>
+auto make_compressed_node_matrix(const matrix<typename Distrib::T>& data, ParamArgs&&... args) {
+    return make_compressed_node_matrix<Distrib>(make_shared_data(compress_patterns(data)),
+                                                std::forward<ParamArgs>(args)...);
+}
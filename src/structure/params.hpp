@@ -92,7 +92,8 @@ struct MatrixParamFactory {
 
     template <class F>
     static auto make(F f) {
-        static_assert(std::is_same<T, std::decay_t<decltype(f(0, 0))>>::value,
+        // convertible rather than same, e.g. for values stored as float (see precision policies)
+        static_assert(std::is_convertible<std::decay_t<decltype(f(0, 0))>, T>::value,
                       "in MatrixParamFactory: incorrect return type");
         return f;
     }
@@ -113,7 +114,8 @@ struct CubixParamFactory {
 
     template <class F>
     static auto make(F f) {
-        static_assert(std::is_same<T, std::decay_t<decltype(f(0, 0, 0))>>::value,
+        // convertible rather than same, e.g. for values stored as float (see precision policies)
+        static_assert(std::is_convertible<std::decay_t<decltype(f(0, 0, 0))>, T>::value,
                       "in CubixParamFactory: incorrect return type");
         return f;
     }
@@ -0,0 +1,67 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <map>
+#include <vector>
+#include "datatypes.hpp"
+
+/*==================================================================================================
+~~ Pattern compression ~~
+Observed data often contains many identical elements or rows (e.g., identical alignment columns).
+PatternData stores each distinct element (or row) once, in order of first appearance, with the
+number of times it appears; compressed nodes (see make_compressed_node_array) weight the
+contribution of each pattern by its count.
+==================================================================================================*/
+template <class Values>
+struct PatternData {
+    Values values;
+    std::vector<size_t> counts;
+    std::vector<size_t> pattern_of;  // pattern of each element (or row) of the original data
+
+    size_t nb_patterns() const { return counts.size(); }
+    size_t nb_elements() const { return pattern_of.size(); }
+};
+
+// elements of data (rows if data is a matrix) are compared with operator<
+template <class Values>
+PatternData<Values> compress_patterns(const Values& data) {
+    PatternData<Values> result;
+    std::map<typename Values::value_type, size_t> index;
+    for (auto& e : data) {
+        auto it = index.find(e);
+        if (it == index.end()) {
+            it = index.emplace(e, result.values.size()).first;
+            result.values.push_back(e);
+            result.counts.push_back(0);
+        }
+        result.counts[it->second]++;
+        result.pattern_of.push_back(it->second);
+    }
+    return result;
+}
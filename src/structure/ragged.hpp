@@ -0,0 +1,140 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <vector>
+
+/*==================================================================================================
+~~ Ragged arrays ~~
+RaggedArray stores an array of variable-length vectors (e.g., per-gene profiles) in a single
+buffer, element i being values[offsets[i]] to values[offsets[i + 1] - 1]. Elements are accessed
+through RaggedRow views, which behave as fixed-size vectors: assigning to a row copies values into
+the buffer. Copying a whole ragged array (e.g., for a backup) is a single contiguous copy.
+==================================================================================================*/
+template <class T>
+class RaggedRow {
+    T* _data;
+    size_t _size;
+
+  public:
+    using value_type = T;
+
+    RaggedRow(T* data, size_t size) : _data(data), _size(size) {}
+    RaggedRow(const RaggedRow&) = default;
+
+    RaggedRow& operator=(const RaggedRow& other) {
+        assign(other.begin(), other.end());
+        return *this;
+    }
+
+    RaggedRow& operator=(const std::vector<T>& other) {
+        assign(other.begin(), other.end());
+        return *this;
+    }
+
+    template <class It>
+    void assign(It first, It last) {
+        assert(size_t(std::distance(first, last)) == _size);
+        std::copy(first, last, _data);
+    }
+
+    operator std::vector<T>() const { return std::vector<T>(begin(), end()); }
+
+    size_t size() const { return _size; }
+    T& operator[](size_t i) { return _data[i]; }
+    const T& operator[](size_t i) const { return _data[i]; }
+    T* begin() { return _data; }
+    T* end() { return _data + _size; }
+    const T* begin() const { return _data; }
+    const T* end() const { return _data + _size; }
+};
+
+template <class T>
+class RaggedArray {
+    std::vector<T> _values;
+    std::vector<size_t> _offsets;
+    std::vector<RaggedRow<T>> _rows;
+
+    void make_rows() {
+        _rows.clear();
+        _rows.reserve(size());
+        for (size_t i = 0; i < size(); i++) {
+            _rows.emplace_back(_values.data() + _offsets[i], _offsets[i + 1] - _offsets[i]);
+        }
+    }
+
+  public:
+    RaggedArray(const std::vector<size_t>& sizes) : _offsets(sizes.size() + 1, 0) {
+        for (size_t i = 0; i < sizes.size(); i++) { _offsets[i + 1] = _offsets[i] + sizes[i]; }
+        _values.assign(_offsets.back(), T());
+        make_rows();
+    }
+
+    RaggedArray(const RaggedArray& other) : _values(other._values), _offsets(other._offsets) {
+        make_rows();
+    }
+
+    RaggedArray(RaggedArray&& other) = default;
+
+    // elements keep their sizes: only the buffer is copied
+    RaggedArray& operator=(const RaggedArray& other) {
+        copy_values(other);
+        return *this;
+    }
+
+    void copy_values(const RaggedArray& other) {
+        assert(other._offsets == _offsets);
+        std::copy(other._values.begin(), other._values.end(), _values.begin());
+    }
+
+    size_t size() const { return _offsets.size() - 1; }
+    RaggedRow<T>& operator[](size_t i) { return _rows[i]; }
+    const RaggedRow<T>& operator[](size_t i) const { return _rows[i]; }
+    auto begin() { return _rows.begin(); }
+    auto end() { return _rows.end(); }
+
+    const std::vector<T>& values() const { return _values; }
+    const std::vector<size_t>& offsets() const { return _offsets; }
+};
+
+// type used to back up a single value (rows of ragged arrays are views)
+template <class T>
+struct value_backup {
+    using type = T;
+};
+
+template <class T>
+struct value_backup<RaggedRow<T>> {
+    using type = std::vector<T>;
+};
+
+template <class T>
+using value_backup_t = typename value_backup<T>::type;
@@ -0,0 +1,165 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+#include <vector>
+#include "datatypes.hpp"
+
+/*==================================================================================================
+~~ Sparse matrix ~~
+Compressed sparse row storage for matrices that are mostly zeros (e.g., count data). Nonzero
+entries of row i are values[row_start[i]] to values[row_start[i + 1] - 1], sorted by column. A
+column index (col_start, col_entries) gives the positions of the entries of each column, so that
+rows and columns can both be traversed in time proportional to their number of nonzeros.
+==================================================================================================*/
+template <class T>
+struct SparseMatrix {
+    size_t nb_rows{0};
+    size_t nb_cols{0};
+    std::vector<size_t> row_start;
+    std::vector<size_t> col_index;
+    std::vector<T> values;
+
+    std::vector<size_t> col_start;
+    std::vector<size_t> col_entries;
+    std::vector<size_t> entry_row;
+
+    size_t nnz() const { return values.size(); }
+
+    T operator()(size_t i, size_t j) const {
+        assert(i < nb_rows and j < nb_cols);
+        auto first = col_index.begin() + row_start[i];
+        auto last = col_index.begin() + row_start[i + 1];
+        auto it = std::lower_bound(first, last, j);
+        return (it != last and *it == j) ? values[it - col_index.begin()] : T(0);
+    }
+
+    // calls f(i, j, value) for the nonzero entries in rows [r0, r1) and columns [c0, c1)
+    template <class F>
+    void across_entries(size_t r0, size_t r1, size_t c0, size_t c1, F f) const {
+        if (c1 == c0 + 1 and r1 > r0 + 1) {
+            for (size_t k = col_start[c0]; k < col_start[c0 + 1]; k++) {
+                size_t pos = col_entries[k];
+                if (entry_row[pos] >= r0 and entry_row[pos] < r1) {
+                    f(entry_row[pos], c0, values[pos]);
+                }
+            }
+        } else {
+            for (size_t i = r0; i < r1; i++) {
+                auto first = col_index.begin() + row_start[i];
+                auto last = col_index.begin() + row_start[i + 1];
+                for (auto it = std::lower_bound(first, last, c0); it != last and *it < c1; it++) {
+                    f(i, *it, values[it - col_index.begin()]);
+                }
+            }
+        }
+    }
+
+    // builds the column index from the row storage
+    void index_columns() {
+        entry_row.assign(nnz(), 0);
+        col_start.assign(nb_cols + 1, 0);
+        for (size_t i = 0; i < nb_rows; i++) {
+            for (size_t pos = row_start[i]; pos < row_start[i + 1]; pos++) {
+                entry_row[pos] = i;
+                col_start[col_index[pos] + 1]++;
+            }
+        }
+        for (size_t j = 0; j < nb_cols; j++) { col_start[j + 1] += col_start[j]; }
+        col_entries.assign(nnz(), 0);
+        auto next = col_start;
+        for (size_t pos = 0; pos < nnz(); pos++) { col_entries[next[col_index[pos]]++] = pos; }
+    }
+};
+
+template <class T>
+SparseMatrix<T> make_sparse_matrix(const matrix<T>& dense) {
+    SparseMatrix<T> result;
+    result.nb_rows = dense.size();
+    result.nb_cols = dense.empty() ? 0 : dense[0].size();
+    result.row_start.push_back(0);
+    for (auto& row : dense) {
+        assert(row.size() == result.nb_cols);
+        for (size_t j = 0; j < row.size(); j++) {
+            if (row[j] != T(0)) {
+                result.col_index.push_back(j);
+                result.values.push_back(row[j]);
+            }
+        }
+        result.row_start.push_back(result.values.size());
+    }
+    result.index_columns();
+    return result;
+}
+
+// from (row, column, value) triplets in any order; zero values are dropped and duplicate
+// coordinates are summed
+template <class T>
+SparseMatrix<T> make_sparse_matrix(size_t nb_rows, size_t nb_cols,
+                                   std::vector<std::tuple<size_t, size_t, T>> triplets) {
+    std::sort(triplets.begin(), triplets.end(), [](const auto& a, const auto& b) {
+        return std::make_pair(std::get<0>(a), std::get<1>(a)) <
+               std::make_pair(std::get<0>(b), std::get<1>(b));
+    });
+    SparseMatrix<T> result;
+    result.nb_rows = nb_rows;
+    result.nb_cols = nb_cols;
+    result.row_start.assign(nb_rows + 1, 0);
+    for (size_t k = 0; k < triplets.size(); k++) {
+        auto& t = triplets[k];
+        size_t i = std::get<0>(t), j = std::get<1>(t);
+        assert(i < nb_rows and j < nb_cols);
+        if (k > 0 and std::get<0>(triplets[k - 1]) == i and std::get<1>(triplets[k - 1]) == j) {
+            result.values.back() += std::get<2>(t);
+        } else {
+            result.col_index.push_back(j);
+            result.values.push_back(std::get<2>(t));
+            result.row_start[i + 1]++;
+        }
+    }
+    for (size_t i = 0; i < nb_rows; i++) { result.row_start[i + 1] += result.row_start[i]; }
+    // drop zeros (including sums of duplicates)
+    size_t kept = 0, pos = 0;
+    for (size_t i = 0; i < nb_rows; i++) {
+        size_t end = result.row_start[i + 1];
+        for (; pos < end; pos++) {
+            if (result.values[pos] != T(0)) {
+                result.col_index[kept] = result.col_index[pos];
+                result.values[kept++] = result.values[pos];
+            }
+        }
+        result.row_start[i + 1] = kept;
+    }
+    result.col_index.resize(kept);
+    result.values.resize(kept);
+    result.index_columns();
+    return result;
+}
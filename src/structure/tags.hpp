@@ -57,6 +57,7 @@ struct constraint {};
 struct root_constraint {};
 
 struct backup_value {};
+struct shared_data {};
 struct suffstat {};
 struct suffstat_type {};
 struct target {};
@@ -87,6 +88,9 @@ struct node_tree_process_tag : node_tag {};
 struct node_cond_tree_process_tag : node_tag {};
 struct node_matrix_tag : node_tag {};
 struct node_cubix_tag : node_tag {};
+struct node_sparse_matrix_tag : node_tag {};
+struct shared_data_tag {};
+struct pattern_counts_tag {};
 
 struct dnode_tag {};
 struct lone_dnode_tag : dnode_tag {};
@@ -47,7 +47,10 @@ auto type_tag(const tagged_tuple<MD, Fields...>&) {
                     node_cubix_tag,
                     conditional_t<is_node_tree_process<T>::value,
                         node_tree_process_tag,
-                        lone_node_tag
+                        conditional_t<is_node_sparse_matrix<T>::value,
+                            node_sparse_matrix_tag,
+                            lone_node_tag
+                        >
                     >
                 >
             >
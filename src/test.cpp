@@ -28,6 +28,8 @@ license and that you accept its terms.*/
 
 #include "doctest.h"
 
+#include <array>
+#include <cstdlib>
 #include <iostream>
 #include "bayes_toolbox.hpp"
 using namespace std;
@@ -375,3 +377,938 @@ TEST_CASE("Profile move") {
         CHECK(v != v_cpy);
     }
 }
+
+TEST_CASE("Dirichlet profile moves") {
+    auto gen = make_generator();
+    auto v = make_node<dirichlet>([]() { return std::vector<double>{2, 3, 5}; });
+    auto no_lp = []() { return 0.; };
+    auto check_prior_means = [&](auto move) {
+        set_value(v, {0.6, 0.3, 0.1});
+        std::vector<double> mean(3, 0.);
+        int nb_it = 20000;
+        for (int it = 0; it < nb_it; it++) {
+            move();
+            CHECK(::sum(raw_value(v)) == doctest::Approx(1.));
+            for (size_t k = 0; k < 3; k++) { mean[k] += raw_value(v)[k] / nb_it; }
+        }
+        CHECK(mean[0] == doctest::Approx(0.2).epsilon(0.1));
+        CHECK(mean[1] == doctest::Approx(0.3).epsilon(0.1));
+        CHECK(mean[2] == doctest::Approx(0.5).epsilon(0.1));
+    };
+    check_prior_means([&]() { profile_sliding_move(v, no_lp, 1, 1.0, 3, gen); });
+    check_prior_means([&]() { profile_dirichlet_move(v, no_lp, 20., 3, gen); });
+    check_prior_means([&]() { profile_scaling_move(v, no_lp, 2, 1.0, 3, gen); });
+
+    auto a = make_node_array<dirichlet_cic>(
+        4, [](int) { return std::vector<double>{0.25, 0.25, 0.5}; }, n_to_const(0.1));
+    for (size_t i = 0; i < 4; i++) { raw_value(a, i) = {0.3, 0.3, 0.4}; }
+    profile_scaling_move(a, [](int) { return 0.; }, 2, 1.0, 10, gen);
+    for (size_t i = 0; i < 4; i++) { CHECK(::sum(raw_value(a, i)) == doctest::Approx(1.)); }
+}
+
+TEST_CASE("Streaming convergence diagnostics") {
+    auto gen = make_generator(17);
+    std::normal_distribution<double> distrib(0, 1);
+    ConvergenceMonitor same(4), shifted(4);
+    for (int it = 0; it < 5000; it++) {
+        for (size_t c = 0; c < 4; c++) {
+            double x = distrib(gen);
+            same.add(c, std::vector<double>{x});
+            shifted.add(c, std::vector<double>{x + c});
+        }
+        if (it == 1000) {
+            same.set_tail_thresholds();
+            shifted.set_tail_thresholds();
+        }
+    }
+    auto d = same.diagnostics().at(0);
+    CHECK(d.mean == doctest::Approx(0).epsilon(0.05));
+    CHECK(d.variance == doctest::Approx(1).epsilon(0.05));
+    CHECK(d.rhat < 1.01);
+    CHECK(d.ess_bulk > 10000);
+    CHECK(d.ess_tail > 5000);
+    CHECK(shifted.diagnostics().at(0).rhat > 1.5);
+    CHECK(shifted.diagnostics().at(0).ess_bulk < 1000);
+}
+
+TEST_CASE("Multi-chain runner") {
+    auto models = make_model_array(4, [](size_t) {
+        auto a = make_node<exponential>(1.0);
+        return make_model(node<n1>(a));
+    });
+    MultiChainSettings settings;
+    settings.burn_in = 0;
+    settings.seed = 17;
+    auto result = run_chains(
+        *models, [](auto& m, auto& gen) { draw(get<n1>(m), gen); },
+        [](auto& m) { return std::array<double, 1>{{raw_value(get<n1>(m))}}; }, settings);
+    CHECK(result.converged);
+    CHECK(result.iterations < settings.max_iterations);
+    CHECK(result.diagnostics.at(0).mean == doctest::Approx(1).epsilon(0.1));
+}
+
+TEST_CASE("SMC on a beta/bernoulli model") {
+    constexpr size_t nb_obs{40}, batch{10};
+    auto gen = make_generator(17);
+    std::vector<pos_integer> data(nb_obs);
+    for (size_t i = 0; i < nb_obs; i++) { data[i] = i % 4 != 0; }  // 30 successes out of 40
+
+    auto particles = make_model_array(500, [&gen](size_t) {
+        auto p = make_node<beta_ss>(1.0, 1.0);
+        auto obs = make_node_array<bernoulli>(nb_obs, n_to_one(p));
+        draw(p, gen);
+        return make_model(node<n1>(p), node<n2>(obs));
+    });
+    auto smc = make_smc_sampler(*particles, [](auto& m) { return make_collection(get<n1>(m)); }, 17);
+
+    for (size_t b = 0; b < nb_obs; b += batch) {
+        smc.for_each([&](auto& m) {
+            for (size_t i = b; i < b + batch; i++) { raw_value(get<n2>(m), i) = data[i]; }
+        });
+        smc.update(
+            [b](auto& m) {
+                auto new_obs = subsets::range(get<n2>(m), b, b + batch);
+                return logprob(new_obs);
+            },
+            [b](auto& m, auto& gen) {
+                auto seen = subsets::range(get<n2>(m), 0, b + batch);
+                slide_constrained_move(get<n1>(m), [&seen]() { return logprob(seen); }, 0.5, 0.,
+                                       1., 5, gen);
+            },
+            gen);
+    }
+    double mean_p = smc.weighted_mean([](auto& m) { return raw_value(get<n1>(m)); });
+    CHECK(mean_p == doctest::Approx(31. / 42.).epsilon(0.03));
+    // log marginal likelihood of the data: log B(31, 11) - log B(1, 1)
+    double log_evidence = std::lgamma(31) + std::lgamma(11) - std::lgamma(42);
+    CHECK(smc.log_evidence() == doctest::Approx(log_evidence).epsilon(0.02));
+}
+
+TEST_CASE("Move scheduler") {
+    auto gen = make_generator(17);
+    std::string trace;
+    auto scheduler = make_scheduler(gen);
+    scheduler.add("a", [&trace](auto&) { trace += "a"; }, 2);
+    scheduler.add("b", [&trace](auto&) { trace += "b"; });
+    scheduler.run(2, gen);
+    CHECK(trace == "aabaab");
+    CHECK(scheduler.nb_calls("a") == 4);
+    CHECK(scheduler.nb_calls("b") == 2);
+
+    auto random_scheduler = make_scheduler(gen, MoveScheduler<decltype(gen)>::random);
+    random_scheduler.add("a", [](auto&) {}, 1, 3.);
+    random_scheduler.add("b", [](auto&) {}, 1, 1.);
+    random_scheduler.enable_timing();
+    random_scheduler.run(5000, gen);
+    CHECK(random_scheduler.nb_calls("a") + random_scheduler.nb_calls("b") == 10000);
+    CHECK(random_scheduler.nb_calls("a") / 10000. == doctest::Approx(0.75).epsilon(0.05));
+    CHECK(random_scheduler.seconds("a") >= 0);
+}
+
+TEST_CASE("Elliptical slice sampling") {
+    auto gen = make_generator(17);
+    // x ~ N(0, 1), y ~ N(x, 1), y = 2 => x | y ~ N(1, 0.5)
+    auto x = make_node<normal>(0.0, 1.0);
+    auto y = make_node<normal>(x, 1.0);
+    set_value(y, 2.0);
+    auto xs = make_node_array<normal>(3, n_to_const(1.0), n_to_const(1.0));
+    auto ys = make_node_array<normal>(3, n_to_n(xs), n_to_const(1.0));
+    set_value(ys, {-1, 1, 3});  // posteriors N(0, 0.5), N(1, 0.5), N(2, 0.5)
+
+    RunningStats stats_x, stats_xs2;
+    for (int it = 0; it < 20000; it++) {
+        elliptical_slice_move(x, simple_logprob(y), 1, gen);
+        elliptical_slice_move(xs, simple_logprob(ys), 1, gen);
+        stats_x.add(raw_value(x));
+        stats_xs2.add(raw_value(xs, 2));
+    }
+    CHECK(stats_x.mean == doctest::Approx(1).epsilon(0.05));
+    CHECK(stats_x.variance() == doctest::Approx(0.5).epsilon(0.05));
+    CHECK(stats_xs2.mean == doctest::Approx(2).epsilon(0.05));
+}
+
+TEST_CASE("Random engines") {
+    // known-answer test from the Random123 distribution
+    philox4x32 philox({{0, 0}}, {{0, 0, 0, 0}});
+    CHECK(philox.generate_block() == std::array<uint32_t, 4>{{0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+                                                               0x9b00dbd8}});
+
+    pcg64 stepped(3), advanced(3);
+    for (int i = 0; i < 1000; i++) { stepped(); }
+    advanced.advance(1000);
+    CHECK(stepped() == advanced());
+
+    auto check_engine = [](auto engine) {
+        auto streams = make_streams<decltype(engine)>(2, 42);
+        auto again = make_streams<decltype(engine)>(2, 42);
+        CHECK(streams[0]() == again[0]());
+        CHECK(streams[0]() != streams[1]());
+        double mean = 0;
+        for (int i = 0; i < 10000; i++) { mean += draw_uniform(streams[1]) / 10000; }
+        CHECK(mean == doctest::Approx(0.5).epsilon(0.02));
+    };
+    check_engine(xoshiro256pp());
+    check_engine(pcg64());
+    check_engine(philox4x32());
+
+    auto uniforms = make_buffered_uniform(xoshiro256pp(7));
+    std::vector<double> v(1000);
+    uniforms();
+    uniforms.fill(v.data(), v.data() + v.size());
+    CHECK(*std::min_element(v.begin(), v.end()) >= 0.);
+    CHECK(*std::max_element(v.begin(), v.end()) < 1.);
+    CHECK(::sum(v) / v.size() == doctest::Approx(0.5).epsilon(0.05));
+}
+
+TEST_CASE("Batched samplers") {
+    CHECK(has_array_draw<gamma_ss>::value);
+    CHECK(has_array_draw<poisson>::value);
+    CHECK(has_array_draw<bernoulli>::value);
+    CHECK(!has_array_draw<dirichlet>::value);
+    CHECK(!has_array_draw<exponential>::value);
+
+    auto gen = make_generator<xoshiro256pp>(5);
+    size_t n = 20000;
+    auto check_moments = [n](const auto& v, double mean, double variance) {
+        double m = 0, m2 = 0;
+        for (auto x : v) {
+            m += double(x) / n;
+            m2 += double(x) * double(x) / n;
+        }
+        CHECK(m == doctest::Approx(mean).epsilon(0.03));
+        CHECK(m2 - m * m == doctest::Approx(variance).epsilon(0.1));
+    };
+
+    // alternating shapes 0.5 and 2 (sampler setup redone for each element)
+    auto g = make_node_array<gamma_ss>(n, [](int i) { return i % 2 ? 2. : 0.5; }, n_to_const(2.));
+    draw(g, gen);
+    check_moments(get<value>(g), 2.5, 7.25);
+    auto g5 = make_node_array<gamma_sr>(n, n_to_const(5.), n_to_const(2.));
+    draw(g5, gen);
+    check_moments(get<value>(g5), 2.5, 1.25);
+
+    auto small = make_node_array<poisson>(n, n_to_const(3.));
+    auto large = make_node_array<poisson>(n, n_to_const(50.));
+    draw(small, gen);
+    draw(large, gen);
+    check_moments(get<value>(small), 3., 3.);
+    check_moments(get<value>(large), 50., 50.);
+
+    auto coins = make_node_array<bernoulli>(n, n_to_const(0.3));
+    draw(coins, gen);
+    check_moments(get<value>(coins), 0.3, 0.21);
+
+    auto b = make_node_array<beta_ss>(n, n_to_const(2.), n_to_const(3.));
+    draw(b, gen);
+    check_moments(get<value>(b), 0.4, 0.04);
+
+    std::vector<double> lone(n);
+    for (auto& x : lone) { gamma_ss::draw(x, 0.1, 1., gen); }
+    check_moments(lone, 0.1, 0.1);
+}
+
+TEST_CASE("Log-factorial tables") {
+    for (size_t n : {0, 1, 2, 10, 63, 64, 1000, 16383, 16384, 100000}) {
+        CHECK(log_factorial(n) == doctest::Approx(std::lgamma(n + 1.)).epsilon(1e-12));
+    }
+    CHECK(log_gamma(7.) == doctest::Approx(std::lgamma(7.)).epsilon(1e-12));
+    CHECK(log_gamma(2.5) == std::lgamma(2.5));
+    CHECK(log_gamma(1e20) == std::lgamma(1e20));
+    for (double n : {0., 3., 16., 17., 2.5, 1000.}) {
+        CHECK(log_rising_factorial(0.7, n) ==
+              doctest::Approx(std::lgamma(0.7 + n) - std::lgamma(0.7)).epsilon(1e-10));
+    }
+    CHECK(poisson::logprob(12, 3.5) ==
+          doctest::Approx(12 * log(3.5) - 3.5 - std::lgamma(13.)).epsilon(1e-12));
+}
+
+TEST_CASE("Logprob of observed nodes") {
+    auto gen = make_generator();
+    CHECK(has_data_logprob<poisson>::value);
+    CHECK(!has_data_logprob<gamma_sr>::value);
+
+    auto lambda = make_node_array<exponential>(3, n_to_const(0.1));
+    auto k = make_node_matrix<poisson>(
+        3, 4, [& v = get<value>(lambda)](int i, int) { return v[i]; });
+    draw(lambda, gen);
+    draw(k, gen);
+    CHECK(param_logprob(k) + data_logprob(k) == doctest::Approx(logprob(k)));
+    CHECK(param_logprob(lambda) == logprob(lambda));
+    CHECK(data_logprob(lambda) == 0);
+
+    // MH ratios are the same with or without the data-only terms
+    auto full = matrix_row_logprob(k);
+    auto observed = observed_matrix_row_logprob(k);
+    double full_before = full(1), observed_before = observed(1);
+    raw_value(lambda, 1) *= 1.5;
+    CHECK(full(1) - full_before == doctest::Approx(observed(1) - observed_before));
+}
+
+TEST_CASE("Partial logprobs") {
+    auto gen = make_generator();
+    auto alpha = make_node<exponential>(1.0);
+    auto beta = make_node<exponential>(1.0);
+    auto lambda_sr = make_node_array<gamma_sr>(5, n_to_one(alpha), n_to_one(beta));
+    auto lambda_ss = make_node_array<gamma_ss>(5, n_to_one(alpha), n_to_one(beta));
+    draw(alpha, gen);
+    draw(beta, gen);
+    draw(lambda_sr, gen);
+    draw(lambda_ss, gen);
+    CHECK(role_index<gamma_sr, value>::value == 0);
+    CHECK(role_index<gamma_sr, shape>::value == 1);
+    CHECK(role_index<gamma_sr, rate>::value == 2);
+    CHECK(role_index<gamma_sr, weights>::value == -1);
+
+    // differences of partial logprobs match differences of full logprobs
+    auto check_role = [&](auto role, auto& node, double& moved) {
+        using Role = decltype(role);
+        double full_before = logprob(node), partial_before = partial_logprob<Role>(node);
+        moved *= 1.3;
+        CHECK(logprob(node) - full_before ==
+              doctest::Approx(partial_logprob<Role>(node) - partial_before));
+    };
+    check_role(shape(), lambda_sr, raw_value(alpha));
+    check_role(rate(), lambda_sr, raw_value(beta));
+    check_role(value(), lambda_sr, raw_value(lambda_sr, 2));
+    check_role(shape(), lambda_ss, raw_value(alpha));
+    using scale_tag = struct scale;  // scale also names the proposal function
+    check_role(scale_tag(), lambda_ss, raw_value(beta));
+    check_role(value(), lambda_ss, raw_value(lambda_ss, 2));
+
+    // distributions without partial terms fall back to the full logprob
+    auto p = make_node<beta_ss>(2., 3.);
+    draw(p, gen);
+    CHECK(partial_logprob<value>(p) == logprob(p));
+}
+
+struct counting_poisson : poisson {
+    static int nb_transforms;
+
+    static transformed_params transform_params(spos_real lambda) {
+        nb_transforms++;
+        return poisson::transform_params(lambda);
+    }
+};
+int counting_poisson::nb_transforms = 0;
+
+TEST_CASE("Hoisting of invariant params") {
+    auto gen = make_generator();
+    CHECK(param_index_mask<decltype(n_to_const(1.0))>::value == 0);
+    CHECK(param_index_mask<decltype(mn_to_m(std::declval<std::vector<double>&>()))>::value == 1);
+    CHECK(param_index_mask<decltype(mn_to_n(std::declval<std::vector<double>&>()))>::value == 2);
+
+    auto lambda = make_node_array<exponential>(3, n_to_const(0.1));
+    draw(lambda, gen);
+    auto& l = get<value>(lambda);
+    auto k_rows = make_node_matrix<counting_poisson>(3, 4, mn_to_m(lambda));
+    auto k_user = make_node_matrix<counting_poisson>(3, 4, [&l](int i, int) { return l[i]; });
+    draw(k_rows, gen);
+    get<value>(k_user) = get<value>(k_rows);
+
+    double expected = 0;
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 4; j++) { expected += poisson::logprob(raw_value(k_rows, i, j), l[i]); }
+    }
+
+    counting_poisson::nb_transforms = 0;
+    CHECK(logprob(k_rows) == doctest::Approx(expected));
+    CHECK(counting_poisson::nb_transforms == 3);  // once per row
+
+    counting_poisson::nb_transforms = 0;
+    CHECK(logprob(k_user) == doctest::Approx(expected));
+    CHECK(counting_poisson::nb_transforms == 0);  // unknown dependencies: nothing to hoist
+    static_assert(overloads::direct_traversal<decltype(k_user)>::value, "");
+    static_assert(!overloads::direct_traversal<decltype(k_rows)>::value, "");
+
+    counting_poisson::nb_transforms = 0;
+    auto row = subsets::row(k_rows, 1);
+    param_logprob(row);
+    CHECK(counting_poisson::nb_transforms == 1);
+
+    auto rate = make_node<exponential>(0.1);
+    draw(rate, gen);
+    auto counts = make_node_array<counting_poisson>(100, n_to_one(rate));
+    counting_poisson::nb_transforms = 0;
+    draw(counts, gen);
+    logprob(counts);
+    CHECK(counting_poisson::nb_transforms == 1);
+}
+
+TEST_CASE("Dirichlet normalizers shared across profiles") {
+    auto gen = make_generator();
+    std::vector<double> center{0.2, 0.3, 0.5};
+    auto profiles = make_node_array<dirichlet>(50, n_to_const(std::vector<double>{2, 3, 5}));
+    auto profiles_cic = make_node_array<dirichlet_cic>(50, n_to_const(center), n_to_const(0.1));
+    for (size_t i = 0; i < 50; i++) {
+        raw_value(profiles, i).resize(3);
+        raw_value(profiles_cic, i).resize(3);
+    }
+    draw(profiles, gen);
+    draw(profiles_cic, gen);
+
+    double expected = 0, expected_cic = 0;
+    for (size_t i = 0; i < 50; i++) {
+        expected += dirichlet::logprob(raw_value(profiles, i), {2, 3, 5});
+        expected_cic += dirichlet_cic::logprob(raw_value(profiles_cic, i), center, 0.1);
+    }
+    CHECK(logprob(profiles) == doctest::Approx(expected));
+    CHECK(logprob(profiles_cic) == doctest::Approx(expected_cic));
+
+    auto element = subsets::element(profiles_cic, 3);
+    double full_before = logprob(element), partial_before = partial_logprob<value>(element);
+    raw_value(profiles_cic, 3) = {0.1, 0.6, 0.3};
+    CHECK(logprob(element) - full_before ==
+          doctest::Approx(partial_logprob<value>(element) - partial_before));
+
+    // concentrations that are not shared are read directly, without copies into transformed params
+    std::vector<std::vector<double>> alphas(50, std::vector<double>{2, 3, 5});
+    auto own_profiles = make_node_array<dirichlet>(50, n_to_n(alphas));
+    static_assert(overloads::direct_traversal<decltype(own_profiles)>::value,
+                  "per-profile concentrations have nothing to hoist");
+    get<value>(own_profiles) = get<value>(profiles);
+    CHECK(logprob(own_profiles) == doctest::Approx(expected));
+}
+
+TEST_CASE("Custom dnodes with typed callables") {
+    auto a = make_node<exponential>(1.0);
+    raw_value(a) = 2.0;
+    std::vector<double> weights{1, 2, 3};
+
+    auto lone = make_custom_dnode<double>([&a](double& x) { x = 3 * raw_value(a); });
+    auto array = make_custom_dnode_array<double>(
+        3, [&a, &weights](double& x, size_t i) { x = weights[i] * raw_value(a); });
+    auto matrix = make_custom_dnode_matrix<double>(
+        2, 3, [&weights](double& x, size_t i, size_t j) { x = i + weights[j]; });
+    gather(lone);
+    gather(array);
+    gather(matrix);
+    CHECK(raw_value(lone) == 6);
+    CHECK(get<value>(array) == std::vector<double>{2, 4, 6});
+    CHECK(raw_value(matrix, 1, 2) == 4);
+
+    raw_value(a) = 0.5;
+    gather(array);
+    CHECK(raw_value(array, 2) == 1.5);
+}
+
+TOKEN(mb_alpha)
+TOKEN(mb_lambda1)
+TOKEN(mb_lambda2)
+TOKEN(mb_mrate)
+TOKEN(mb_K)
+
+TEST_CASE("Markov blankets from param bindings") {
+    auto gen = make_generator();
+    auto alpha = make_node<exponential>(1.0);
+    auto lambda1 = make_node_array<gamma_sr>(3, n_to_one(alpha), n_to_const(1.0));
+    auto lambda2 = make_node_array<gamma_ss>(4, n_to_const(1.0), n_to_const(1.0));
+    auto mrate = make_dnode_matrix<product>(3, 4, mn_to_m(lambda1), mn_to_n(lambda2));
+    auto K = make_node_matrix<poisson>(3, 4, mn_to_mn(mrate));
+    auto m = make_model(mb_alpha_ = std::move(alpha), mb_lambda1_ = std::move(lambda1),
+                        mb_lambda2_ = std::move(lambda2), mb_mrate_ = std::move(mrate),
+                        mb_K_ = std::move(K));
+    draw(mb_alpha_(m), gen);
+    draw(mb_lambda1_(m), gen);
+    draw(mb_lambda2_(m), gen);
+    gather(mb_mrate_(m));
+    draw(mb_K_(m), gen);
+
+    CHECK(blanket_logprob(m, mb_alpha_(m))() == doctest::Approx(param_logprob(mb_lambda1_(m))));
+    CHECK(blanket_logprob(m, mb_lambda1_(m))(1) ==
+          doctest::Approx(observed_matrix_row_logprob(mb_K_(m))(1)));
+    CHECK(blanket_logprob(m, mb_lambda2_(m))(2) ==
+          doctest::Approx(observed_matrix_column_logprob(mb_K_(m))(2)));
+    auto K_element = subsets::element(mb_K_(m), 1, 2);
+    CHECK(blanket_logprob(m, mb_mrate_(m))(1, 2) == doctest::Approx(param_logprob(K_element)));
+
+    // only the dependent row of mrate is updated
+    raw_value(mb_lambda1_(m), 1) = 2.0;
+    raw_value(mb_mrate_(m), 0, 0) = -1;
+    blanket_gather(m, mb_lambda1_(m))(1);
+    CHECK(raw_value(mb_mrate_(m), 1, 3) == doctest::Approx(2.0 * raw_value(mb_lambda2_(m), 3)));
+    CHECK(raw_value(mb_mrate_(m), 0, 0) == -1);
+    blanket_gather(m, mb_alpha_(m))();
+    CHECK(raw_value(mb_mrate_(m), 0, 0) == -1);
+}
+
+TOKEN(mx_rates)
+TOKEN(mx_alloc)
+TOKEN(mx_K)
+
+TEST_CASE("Markov blankets of mixtures") {
+    auto rates = make_node_array<gamma_ss>(3, n_to_const(1.0), n_to_const(1.0));
+    auto alloc = make_node_array<categorical>(5, n_to_const(std::vector<double>(3, 1. / 3)));
+    auto K = make_node_array<poisson>(5, n_to_mix(get<value>(rates), get<value>(alloc)));
+    auto m = make_model(mx_rates_ = std::move(rates), mx_alloc_ = std::move(alloc),
+                        mx_K_ = std::move(K));
+    set_value(mx_rates_(m), std::vector<double>{0.5, 2.0, 10.0});
+    set_value(mx_alloc_(m), std::vector<pos_integer>{0, 1, 2, 1, 0});
+    set_value(mx_K_(m), std::vector<pos_integer>{1, 2, 9, 3, 0});
+
+    // the allocation of a site only affects the observation at that site (up to data-only terms)
+    CHECK(blanket_logprob(m, mx_alloc_(m))(2) == doctest::Approx(9 * log(10.0) - 10.0));
+    CHECK(blanket_logprob(m, mx_rates_(m))(0) == doctest::Approx(param_logprob(mx_K_(m))));
+}
+
+TEST_CASE("Cloning models") {
+    auto gen = make_generator();
+    auto alpha = make_node<exponential>(1.0);
+    auto lambda = make_node_array<gamma_sr>(3, n_to_one(alpha), n_to_const(1.0));
+    auto K = make_node_matrix<poisson>(3, 2, mn_to_m(lambda));
+    auto m = make_model(node<n1>(alpha), node<n2>(lambda), node<n3>(K));
+    draw(get<n1>(m), gen);
+    draw(get<n2>(m), gen);
+    draw(get<n3>(m), gen);
+
+    auto clones = clone_model_array(3, m);
+    auto& c = clones->at(1);
+    double lp = logprob(get<n2>(m)) + logprob(get<n3>(m));
+    CHECK(logprob(get<n2>(c)) + logprob(get<n3>(c)) == doctest::Approx(lp));
+
+    // params of the clone read the values of the clone
+    raw_value(get<n1>(c)) *= 2;
+    raw_value(get<n2>(c), 0) *= 2;
+    CHECK(logprob(get<n2>(m)) + logprob(get<n3>(m)) == doctest::Approx(lp));
+    CHECK(logprob(get<n2>(c)) ==
+          doctest::Approx(gamma_sr::logprob(raw_value(get<n2>(c), 0), raw_value(get<n1>(c)), 1.0) +
+                          gamma_sr::logprob(raw_value(get<n2>(m), 1), raw_value(get<n1>(c)), 1.0) +
+                          gamma_sr::logprob(raw_value(get<n2>(m), 2), raw_value(get<n1>(c)), 1.0)));
+    auto row = subsets::row(get<n3>(c), 0);
+    CHECK(logprob(row) ==
+          doctest::Approx(poisson::logprob(raw_value(get<n3>(m), 0, 0), raw_value(get<n2>(c), 0)) +
+                          poisson::logprob(raw_value(get<n3>(m), 0, 1), raw_value(get<n2>(c), 0))));
+
+    // relocating clones does not invalidate them
+    auto moved = std::move(clones->at(2));
+    CHECK(logprob(get<n2>(moved)) + logprob(get<n3>(moved)) == doctest::Approx(lp));
+
+    // mixtures read the components and the allocation of the clone
+    auto rates = make_node_array<gamma_ss>(2, n_to_const(1.0), n_to_const(1.0));
+    auto alloc = make_node_array<categorical>(3, n_to_const(std::vector<double>(2, 0.5)));
+    auto counts = make_node_array<poisson>(3, n_to_mix(get<value>(rates), get<value>(alloc)));
+    auto mix = make_model(node<n1>(rates), node<n2>(alloc), node<n3>(counts));
+    set_value(get<n1>(mix), std::vector<double>{1.0, 2.0});
+    set_value(get<n2>(mix), std::vector<pos_integer>{0, 1, 0});
+    set_value(get<n3>(mix), std::vector<pos_integer>{1, 2, 0});
+    auto mix_clone = clone_model(mix);
+    double mix_lp = logprob(get<n3>(mix));
+    raw_value(get<n1>(mix_clone), 0) = 50;
+    raw_value(get<n2>(mix_clone), 1) = 0;
+    CHECK(logprob(get<n3>(mix)) == doctest::Approx(mix_lp));
+    CHECK(logprob(get<n3>(mix_clone)) ==
+          doctest::Approx(poisson::logprob(1, 50) + poisson::logprob(2, 50) +
+                          poisson::logprob(0, 50)));
+}
+
+TEST_CASE("Observed data shared between models") {
+    auto data = make_shared_data(matrix<pos_integer>{{1, 2}, {0, 3}, {4, 1}});
+    auto make = [&data]() {
+        auto lambda = make_node_array<gamma_ss>(3, n_to_const(1.0), n_to_const(1.0));
+        auto K = make_observed_node_matrix<poisson>(data, mn_to_m(lambda));
+        return make_model(node<n1>(lambda), node<n2>(K));
+    };
+    auto m1 = make();
+    auto m2 = make();
+    auto m3 = clone_model(m1);
+    CHECK(&get<n2, value>(m1) == data.get());
+    CHECK(&get<n2, value>(m2) == data.get());
+    CHECK(&get<n2, value>(m3) == data.get());
+    CHECK(data.use_count() == 4);
+    using observed_value = std::remove_reference_t<decltype(raw_value(get<n2>(m1), 0, 0))>;
+    static_assert(std::is_const<observed_value>::value, "observed data should be read-only");
+
+    auto gen = make_generator();
+    draw(get<n1>(m1), gen);
+    double expected = 0;
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 2; j++) {
+            expected += poisson::logprob((*data)[i][j], raw_value(get<n1>(m1), i));
+        }
+    }
+    CHECK(logprob(get<n2>(m1)) == doctest::Approx(expected));
+    raw_value(get<n1>(m3), 0) = 10.0;  // clone reads its own params
+    CHECK(logprob(get<n2>(m1)) == doctest::Approx(expected));
+    auto row = subsets::row(get<n2>(m3), 0);
+    CHECK(logprob(row) == doctest::Approx(poisson::logprob(1, 10.0) + poisson::logprob(2, 10.0)));
+}
+
+TEST_CASE("Memory-mapped observed data") {
+    char dir_template[] = "/tmp/bayes_toolbox_test_XXXXXX";
+    REQUIRE(mkdtemp(dir_template) != nullptr);
+    std::string dir = dir_template, K_path = dir + "/K.bin", x_path = dir + "/x.bin";
+    matrix<pos_integer> counts{{1, 2, 0}, {3, 0, 5}};
+    write_mapped_matrix(K_path, counts);
+    write_mapped_array(x_path, std::vector<double>{0.5, 1.5});
+
+    auto x = map_array<double>(x_path);
+    CHECK(x->size() == 2);
+    CHECK((*x)[1] == 1.5);
+    CHECK_THROWS(map_array<float>(x_path));
+    CHECK_THROWS(map_matrix<pos_integer>(x_path));
+
+    auto lambda = make_node_array<gamma_ss>(2, n_to_const(1.0), n_to_const(1.0));
+    raw_value(lambda, 0) = 0.7;
+    raw_value(lambda, 1) = 2.5;
+    auto K = make_observed_node_matrix<poisson>(map_matrix<pos_integer>(K_path),
+                                               mn_to_m(lambda));
+    auto K_copy = make_node_matrix<poisson>(2, 3, mn_to_m(lambda));
+    set_value(K_copy, counts);
+    CHECK(raw_value(K, 1, 2) == 5);
+    CHECK(logprob(K) == doctest::Approx(logprob(K_copy)));
+    auto column = subsets::column(K, 1);
+    auto column_copy = subsets::column(K_copy, 1);
+    CHECK(logprob(column) == doctest::Approx(logprob(column_copy)));
+
+    std::remove(K_path.c_str());
+    std::remove(x_path.c_str());
+    std::remove(dir.c_str());
+}
+
+TEST_CASE("Bulk set_value") {
+    auto a = make_node_array<poisson>(4, n_to_const(1.0));
+    auto m = make_node_matrix<poisson>(2, 3, mn_to_const(1.0));
+    auto b = make_node_array<gamma_ss>(4, n_to_n(a), n_to_const(1.0));
+
+    std::vector<pos_integer> values{4, 3, 2, 1};
+    auto buffer = values.data();
+    adopt_value(a, std::move(values));
+    CHECK(get<value>(a).data() == buffer);
+    CHECK(get<params, shape>(b)(2) == 2);
+
+    pos_integer raw[] = {1, 2, 3, 4, 5, 6};
+    set_value_range(m, raw, raw + 6);
+    CHECK(get<value>(m) == matrix<pos_integer>{{1, 2, 3}, {4, 5, 6}});
+    set_value_range(m, 1, raw, raw + 3);
+    CHECK(get<value>(m)[1] == std::vector<pos_integer>{1, 2, 3});
+    set_value_range(a, raw + 2, raw + 6);
+    CHECK(get<value>(a) == std::vector<pos_integer>{3, 4, 5, 6});
+
+    matrix<pos_integer> mv{{7, 8, 9}, {10, 11, 12}};
+    set_value(m, mv);
+    CHECK(get<value>(m) == mv);
+    adopt_value(m, std::move(mv));
+    CHECK(raw_value(m, 1, 2) == 12);
+
+    // temporaries are copied in place, so bindings to single elements remain valid
+    auto lam = make_node_array<gamma_ss>(3, n_to_const(1.0), n_to_const(1.0));
+    auto k = make_node<poisson>(raw_value(lam, 2));
+    auto element = &raw_value(lam, 2);
+    set_value(lam, std::vector<double>{4, 5, 6});
+    CHECK(&raw_value(lam, 2) == element);
+    CHECK(logprob(k) == doctest::Approx(poisson::logprob(0, 6)));
+}
+
+TEST_CASE("Compact storage of integer nodes") {
+    auto gen = make_generator();
+    auto flips = make_compact_node_array<bernoulli, uint8_t>(1000, n_to_const(0.3));
+    static_assert(sizeof(get<value>(flips)[0]) == 1, "bernoulli values should take one byte");
+    draw(flips, gen);
+    size_t nb_heads = 0;
+    for (auto flip : get<value>(flips)) { nb_heads += flip; }
+    CHECK(nb_heads / 1000.0 == doctest::Approx(0.3).epsilon(0.2));
+
+    auto lambda = make_node_array<gamma_ss>(2, n_to_const(1.0), n_to_const(1.0));
+    raw_value(lambda, 0) = 2.0;
+    raw_value(lambda, 1) = 30.0;
+    auto K = make_compact_node_matrix<poisson, uint32_t>(2, 3, mn_to_m(lambda));
+    auto K_wide = make_node_matrix<poisson>(2, 3, mn_to_m(lambda));
+    draw(K, gen);
+    matrix<pos_integer> counts(2, std::vector<pos_integer>(3));
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < 3; j++) { counts[i][j] = raw_value(K, i, j); }
+    }
+    set_value(K_wide, counts);
+    CHECK(logprob(K) == doctest::Approx(logprob(K_wide)));
+    CHECK(param_logprob(K) == doctest::Approx(param_logprob(K_wide)));
+
+    set_value(K, matrix<pos_integer>{{1, 2, 3}, {4, 5, 6}});
+    CHECK(raw_value(K, 1, 2) == 6u);
+}
+
+TOKEN(sp_lambda)
+TOKEN(sp_K)
+
+TEST_CASE("Sparse node matrices") {
+    auto gen = make_generator();
+    auto lambda = make_node_array<gamma_ss>(4, n_to_const(1.0), n_to_const(1.0));
+    auto mu = make_node_array<gamma_ss>(5, n_to_const(1.0), n_to_const(1.0));
+    draw(lambda, gen);
+    draw(mu, gen);
+
+    matrix<pos_integer> counts(4, std::vector<pos_integer>(5, 0));
+    counts[0][1] = 3;
+    counts[2][4] = 1;
+    counts[3][0] = 7;
+    counts[3][4] = 2;
+    auto data = make_sparse_matrix(counts);
+    CHECK(data.nnz() == 4);
+    CHECK(data(3, 4) == 2);
+    CHECK(data(1, 1) == 0);
+    auto from_triplets = make_sparse_matrix<pos_integer>(
+        4, 5, {{3, 4, 1}, {0, 1, 3}, {3, 0, 7}, {2, 4, 1}, {3, 4, 1}, {1, 2, 0}});
+    CHECK(from_triplets.row_start == data.row_start);
+    CHECK(from_triplets.col_index == data.col_index);
+    CHECK(from_triplets.values == data.values);
+
+    auto check_same = [&counts](auto& sparse, auto& dense) {
+        set_value(dense, counts);
+        CHECK(logprob(sparse) == doctest::Approx(logprob(dense)));
+        CHECK(param_logprob(sparse) == doctest::Approx(param_logprob(dense)));
+        for (size_t i = 0; i < 4; i++) {
+            auto sparse_row = subsets::row(sparse, i);
+            auto dense_row = subsets::row(dense, i);
+            CHECK(logprob(sparse_row) == doctest::Approx(logprob(dense_row)));
+        }
+        for (size_t j = 0; j < 5; j++) {
+            auto sparse_column = subsets::column(sparse, j);
+            auto dense_column = subsets::column(dense, j);
+            CHECK(param_logprob(sparse_column) == doctest::Approx(param_logprob(dense_column)));
+        }
+        auto sparse_element = subsets::element(sparse, 3, 0);
+        auto dense_element = subsets::element(dense, 3, 0);
+        CHECK(logprob(sparse_element) == doctest::Approx(logprob(dense_element)));
+    };
+
+    auto K_rows = make_sparse_node_matrix<poisson>(data, mn_to_m(lambda));
+    auto K_rows_dense = make_node_matrix<poisson>(4, 5, mn_to_m(lambda));
+    check_same(K_rows, K_rows_dense);
+    auto K_cols = make_sparse_node_matrix<poisson>(data, mn_to_n(mu));
+    auto K_cols_dense = make_node_matrix<poisson>(4, 5, mn_to_n(mu));
+    check_same(K_cols, K_cols_dense);
+    auto K_const = make_sparse_node_matrix<poisson>(data, mn_to_const(2.0));
+    auto K_const_dense = make_node_matrix<poisson>(4, 5, mn_to_const(2.0));
+    check_same(K_const, K_const_dense);
+
+    auto K = make_sparse_node_matrix<poisson>(data, mn_to_m(lambda));
+    auto m = make_model(sp_lambda_ = std::move(lambda), sp_K_ = std::move(K));
+    auto row = subsets::row(sp_K_(m), 3);
+    CHECK(blanket_logprob(m, sp_lambda_(m))(3) == doctest::Approx(param_logprob(row)));
+
+    size_t total = 0, nb_cells = 0;
+    across_values(K_rows, [&](auto x) {
+        total += x;
+        nb_cells++;
+    });
+    CHECK(total == 13);
+    CHECK(nb_cells == 20);
+}
+
+TEST_CASE("Sparse node matrices at a support boundary") {
+    using T = bernoulli::T;
+    auto ones = make_sparse_node_matrix<bernoulli>(
+        make_sparse_matrix(matrix<T>(3, std::vector<T>(4, 1))), mn_to_const(1.0));
+    CHECK(logprob(ones) == 0);
+    auto row = subsets::row(ones, 1);
+    CHECK(logprob(row) == 0);
+
+    matrix<T> one_row(3, std::vector<T>(4, 0));
+    one_row[0].assign(4, 1);
+    auto mixed = make_sparse_node_matrix<bernoulli>(make_sparse_matrix(one_row), mn_to_const(1.0));
+    double lp = logprob(mixed);
+    CHECK(std::isinf(lp));
+    CHECK(lp < 0);
+
+    // backups of the whole node
+    auto bkp = backup(mixed);
+    get<value>(mixed) = make_sparse_matrix(matrix<T>(3, std::vector<T>(4, 1)));
+    CHECK(logprob(mixed) == 0);
+    restore(mixed, bkp);
+    CHECK(std::isinf(logprob(mixed)));
+}
+
+TEST_CASE("Compressed observed patterns") {
+    auto gen = make_generator();
+    auto p = make_node<beta_ss>(1.0, 1.0);
+    raw_value(p) = 0.3;
+    std::vector<pos_integer> tosses(1000);
+    for (size_t i = 0; i < tosses.size(); i++) { tosses[i] = i % 3 == 0; }
+
+    auto flips = make_compressed_node_array<bernoulli>(tosses, n_to_one(p));
+    auto flips_full = make_node_array<bernoulli>(1000, n_to_one(p));
+    set_value(flips_full, tosses);
+    CHECK(get<value>(flips).size() == 2);
+    CHECK(get<shared_data>(flips)->nb_elements() == 1000);
+    CHECK(logprob(flips) == doctest::Approx(logprob(flips_full)));
+    CHECK(param_logprob(flips) == doctest::Approx(param_logprob(flips_full)));
+    CHECK(data_logprob(flips) == doctest::Approx(data_logprob(flips_full)));
+
+    double nb_heads = 0, nb_tosses = 0;
+    across_weighted_values(flips, [&](pos_integer x, double weight) {
+        nb_heads += x * weight;
+        nb_tosses += weight;
+    });
+    CHECK(nb_heads == 334);
+    CHECK(nb_tosses == 1000);
+
+    auto mu = make_node_array<gamma_ss>(3, n_to_const(1.0), n_to_const(1.0));
+    draw(mu, gen);
+    matrix<pos_integer> counts(50);
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] = std::vector<pos_integer>{i % 3, 2, i % 2};
+    }
+    auto K = make_compressed_node_matrix<poisson>(counts, mn_to_n(mu));
+    auto K_full = make_node_matrix<poisson>(50, 3, mn_to_n(mu));
+    set_value(K_full, counts);
+    CHECK(get<value>(K).size() == 6);
+    CHECK(logprob(K) == doctest::Approx(logprob(K_full)));
+    auto column = subsets::column(K, 2);
+    auto column_full = subsets::column(K_full, 2);
+    CHECK(param_logprob(column) == doctest::Approx(param_logprob(column_full)));
+    CHECK(partial_logprob<value>(column) == doctest::Approx(partial_logprob<value>(column_full)));
+    static_assert(!overloads::unweighted_traversal<decltype(column)>::value,
+                  "compressed nodes need weights");
+    static_assert(overloads::unweighted_traversal<decltype(column_full)>::value,
+                  "plain nodes are traversed directly");
+}
+
+TEST_CASE("Fixed-size dirichlet profiles") {
+    auto gen = make_generator();
+    using profile4 = std::array<double, 4>;
+    auto profiles = make_node_array<fixed_dirichlet<4>>(100, n_to_const(profile4{{1, 2, 3, 4}}));
+    static_assert(sizeof(get<value>(profiles)[0]) == 4 * sizeof(double),
+                  "fixed-size profiles should be stored inline");
+    draw(profiles, gen);
+    auto dynamic = make_node_array<dirichlet>(100, n_to_const(std::vector<double>{1, 2, 3, 4}));
+    for (size_t i = 0; i < 100; i++) {
+        auto& profile = raw_value(profiles, i);
+        CHECK(profile[0] + profile[1] + profile[2] + profile[3] == doctest::Approx(1.));
+        raw_value(dynamic, i).assign(profile.begin(), profile.end());
+    }
+    CHECK(logprob(profiles) == doctest::Approx(logprob(dynamic)));
+    CHECK(partial_logprob<value>(profiles) == doctest::Approx(partial_logprob<value>(dynamic)));
+
+    profile_scaling_move(profiles, [](int) { return 0.; }, 2, 1.0, 3, gen);
+    profile_dirichlet_move(profiles, [](int) { return 0.; }, 20., 3, gen);
+    for (size_t i = 0; i < 100; i++) {
+        auto& profile = raw_value(profiles, i);
+        CHECK(profile[0] + profile[1] + profile[2] + profile[3] == doctest::Approx(1.));
+    }
+
+    auto cic = make_node_array<fixed_dirichlet_cic<4>>(10, n_to_const(profile4{{.1, .2, .3, .4}}),
+                                                        n_to_const(0.1));
+    draw(cic, gen);
+    double expected = 0;
+    for (size_t i = 0; i < 10; i++) {
+        expected += fixed_dirichlet<4>::logprob(raw_value(cic, i), profile4{{1, 2, 3, 4}});
+    }
+    CHECK(logprob(cic) == doctest::Approx(expected));
+}
+
+TEST_CASE("Ragged profile arrays") {
+    auto gen = make_generator();
+    std::vector<size_t> sizes{2, 4, 3, 20};
+    auto profiles = make_ragged_node_array<ragged_dirichlet>(
+        sizes, [&sizes](int i) { return std::vector<double>(sizes[i], 2.0); });
+    CHECK(get<value>(profiles).values().size() == 29);
+    CHECK(raw_value(profiles, 3).size() == 20);
+    draw(profiles, gen);
+    double expected = 0;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        std::vector<double> profile = raw_value(profiles, i);
+        CHECK(::sum(profile) == doctest::Approx(1.));
+        expected += dirichlet::logprob(profile, std::vector<double>(sizes[i], 2.0));
+    }
+    CHECK(logprob(profiles) == doctest::Approx(expected));
+
+    auto bkp = backup(profiles);
+    std::vector<double> before = raw_value(profiles, 1);
+    raw_value(profiles, 1) = std::vector<double>{0.1, 0.2, 0.3, 0.4};
+    restore(profiles, bkp);
+    CHECK(std::vector<double>(raw_value(profiles, 1)) == before);
+
+    auto element = subsets::element(profiles, 2);
+    auto element_bkp = backup(element);
+    before = raw_value(profiles, 2);
+    raw_value(profiles, 2) = std::vector<double>{0.2, 0.2, 0.6};
+    restore(element, element_bkp);
+    CHECK(std::vector<double>(raw_value(profiles, 2)) == before);
+
+    profile_scaling_move(profiles, [](int) { return 0.; }, 2, 1.0, 3, gen);
+    for (size_t i = 0; i < sizes.size(); i++) {
+        CHECK(::sum(std::vector<double>(raw_value(profiles, i))) == doctest::Approx(1.));
+    }
+}
+
+TEST_CASE("Arena-backed nodes") {
+    auto gen = make_generator();
+    auto arena = make_arena(size_t(1) << 22, true);
+    auto lambda = make_arena_node_array<gamma_ss>(arena, 1000, n_to_const(1.0), n_to_const(1.0));
+    auto K = make_arena_node_matrix<poisson>(arena, 1000, 5, mn_to_m(lambda));
+    CHECK(reinterpret_cast<uintptr_t>(get<value>(lambda).data()) % Arena::alignment == 0);
+    CHECK(reinterpret_cast<uintptr_t>(get<value>(K)[1].data()) % Arena::alignment == 0);
+    CHECK(arena->used() >= 1000 * sizeof(double) + 5000 * sizeof(pos_integer));
+    draw(lambda, gen);
+    draw(K, gen);
+
+    // deterministic nodes
+    auto mu = make_arena_node_array<gamma_ss>(arena, 5, n_to_const(1.0), n_to_const(1.0));
+    auto rate = make_arena_dnode_matrix<product>(arena, 1000, 5, mn_to_m(lambda), mn_to_n(mu));
+    auto total = make_arena_dnode_array<product>(arena, 5, n_to_n(mu), n_to_const(2.0));
+    CHECK(reinterpret_cast<uintptr_t>(get<value>(rate)[7].data()) % Arena::alignment == 0);
+    draw(mu, gen);
+    gather(rate);
+    gather(total);
+    CHECK(raw_value(rate, 7, 3) == doctest::Approx(raw_value(lambda, 7) * raw_value(mu, 3)));
+    CHECK(raw_value(total, 4) == doctest::Approx(2 * raw_value(mu, 4)));
+
+    double expected = 0;
+    for (size_t i = 0; i < 1000; i++) {
+        for (size_t j = 0; j < 5; j++) {
+            expected += poisson::logprob(raw_value(K, i, j), raw_value(lambda, i));
+        }
+    }
+    CHECK(logprob(K) == doctest::Approx(expected));
+
+    // backups go to the heap
+    size_t used = arena->used();
+    auto bkp = backup(K);
+    raw_value(K, 3, 2) += 1;
+    restore(K, bkp);
+    CHECK(logprob(K) == doctest::Approx(expected));
+    auto row_logprob = [&K](int i) {
+        auto row = subsets::row(K, i);
+        return logprob(row);
+    };
+    scaling_move(lambda, row_logprob, 1.0, 2, gen);
+    CHECK(arena->used() == used);
+}
+
+TEST_CASE("Single-precision storage") {
+    auto gen = make_generator();
+    auto lambda = make_node_array_with_precision<gamma_ss, single_precision>(
+        500, n_to_const(2.0), n_to_const(1.0));
+    static_assert(sizeof(get<value>(lambda)[0]) == sizeof(float), "values should be floats");
+    auto K = make_node_matrix_with_precision<poisson, single_precision>(500, 4, mn_to_m(lambda));
+    static_assert(std::is_same<std::decay_t<decltype(raw_value(K, 0, 0))>, pos_integer>::value,
+                  "integer values are not affected by the precision policy");
+    draw(lambda, gen);
+    draw(K, gen);
+
+    auto lambda_wide = make_node_array<gamma_ss>(500, n_to_const(2.0), n_to_const(1.0));
+    for (size_t i = 0; i < 500; i++) { raw_value(lambda_wide, i) = raw_value(lambda, i); }
+    CHECK(logprob(lambda) == doctest::Approx(logprob(lambda_wide)));
+    CHECK(mean(get<value>(lambda_wide)) == doctest::Approx(2.0).epsilon(0.15));
+
+    set_value(lambda, std::vector<double>(500, 1.5));
+    CHECK(raw_value(lambda, 7) == 1.5f);
+    auto row_logprob = [&K](int i) {
+        auto row = subsets::row(K, i);
+        return logprob(row);
+    };
+    scaling_move(lambda, row_logprob, 1.0, 2, gen);
+    CHECK(raw_value(lambda, 7) > 0);
+
+    // gibbs updates go through a double temporary
+    struct counts_beta {
+        double count, beta;
+    };
+    struct array_ss {
+        std::vector<counts_beta> ss;
+        counts_beta& get(int i) { return ss[i]; }
+    } ss{std::vector<counts_beta>(500, {1000, 500})};
+    auto mu = make_node_array_with_precision<gamma_mi, single_precision>(
+        500, n_to_const(1.0), n_to_const(1.0));
+    gibbs_resample(mu, ss, gen);
+    CHECK(mean(std::vector<double>(get<value>(mu).begin(), get<value>(mu).end())) ==
+          doctest::Approx(2.0).epsilon(0.05));
+}
@@ -0,0 +1,133 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <sys/mman.h>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+/*==================================================================================================
+~~ Arena allocation ~~
+An Arena is a single anonymous memory region from which node values are allocated one after the
+other, 64-byte aligned, so that the values of a model lie in one region instead of being scattered
+over the heap. Nothing is freed before the arena itself, which happens when the last node using it
+is destroyed (nodes hold it through their ArenaAllocator). With huge_pages, the region is advised
+to be backed by transparent huge pages (MADV_HUGEPAGE), which reduces TLB misses on large models.
+    auto arena = make_arena(size_t(1) << 30, true);
+    auto lambda = make_arena_node_array<gamma_ss>(arena, n, n_to_const(1.0), n_to_const(1.0));
+    auto rate = make_arena_dnode_matrix<product>(arena, n, m, mn_to_m(lambda), mn_to_n(mu));
+Only arrays and matrices (nodes and dnodes) have arena makers; lone values stay on the heap.
+==================================================================================================*/
+class Arena {
+    char* _begin{nullptr};
+    size_t _capacity{0};
+    size_t _used{0};
+
+  public:
+    static constexpr size_t alignment = 64;
+    static constexpr size_t huge_page_size = size_t(1) << 21;
+
+    // capacity is reserved, not committed: pages are only backed by memory when first written
+    explicit Arena(size_t capacity, bool huge_pages = false) : _capacity(capacity) {
+        void* address = mmap(nullptr, capacity, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (address == MAP_FAILED) { throw std::runtime_error("Arena: could not map region"); }
+        _begin = static_cast<char*>(address);
+#ifdef MADV_HUGEPAGE
+        if (huge_pages and capacity >= huge_page_size) {
+            madvise(address, capacity, MADV_HUGEPAGE);
+        }
+#else
+        (void)huge_pages;
+#endif
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() { munmap(_begin, _capacity); }
+
+    void* allocate(size_t bytes) {
+        size_t start = (_used + alignment - 1) / alignment * alignment;
+        if (start + bytes > _capacity) { throw std::bad_alloc(); }
+        _used = start + bytes;
+        return _begin + start;
+    }
+
+    size_t used() const { return _used; }
+    size_t capacity() const { return _capacity; }
+};
+
+inline std::shared_ptr<Arena> make_arena(size_t capacity, bool huge_pages = false) {
+    return std::make_shared<Arena>(capacity, huge_pages);
+}
+
+// allocator for containers stored in an arena; deallocation is a no-op (memory goes with the
+// arena). Copies of these containers (e.g., backups or clones) are allocated on the heap, so that
+// repeated backups do not exhaust the arena.
+template <class T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    std::shared_ptr<Arena> arena;  // heap allocation if null
+
+    ArenaAllocator(std::shared_ptr<Arena> arena = nullptr) : arena(std::move(arena)) {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        if (arena == nullptr) { return static_cast<T*>(::operator new(n * sizeof(T))); }
+        return static_cast<T*>(arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t) {
+        if (arena == nullptr) { ::operator delete(p); }
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.arena == b.arena;
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.arena != b.arena;
+}
+
+template <class T>
+using arena_vector = std::vector<T, ArenaAllocator<T>>;
+
+template <class T>
+using arena_matrix = std::vector<arena_vector<T>, ArenaAllocator<arena_vector<T>>>;
@@ -0,0 +1,325 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <vector>
+
+/*==================================================================================================
+~~ Streaming statistics ~~
+All the accumulators below have a bounded memory footprint: chains are monitored without storing
+their traces.
+==================================================================================================*/
+
+// Welford mean/variance accumulator; two accumulators can be merged (Chan et al. formula)
+struct RunningStats {
+    double count{0};
+    double mean{0};
+    double m2{0};
+
+    void add(double x) {
+        count += 1;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+    }
+
+    void merge(const RunningStats& other) {
+        if (other.count == 0) { return; }
+        double total = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * count * other.count / total;
+        count = total;
+    }
+
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0.; }
+};
+
+// P-square online quantile estimator (Jain & Chlamtac, 1985): five markers, no stored samples
+class P2Quantile {
+    double p;
+    size_t count{0};
+    double q[5];       // marker heights
+    double n[5];       // marker positions
+    double target[5];  // desired marker positions
+    double increment[5];
+
+    double parabolic(int i, double d) const {
+        return q[i] + d / (n[i + 1] - n[i - 1]) *
+                          ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                           (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+    }
+
+    double linear(int i, int d) const {
+        return q[i] + d * (q[i + d] - q[i]) / (n[i + d] - n[i]);
+    }
+
+  public:
+    P2Quantile(double p) : p(p) {
+        double incr[5] = {0, p / 2, p, (1 + p) / 2, 1};
+        double targ[5] = {0, 2 * p, 4 * p, 2 + 2 * p, 4};
+        for (int i = 0; i < 5; i++) {
+            increment[i] = incr[i];
+            target[i] = targ[i];
+            n[i] = i;
+        }
+    }
+
+    void add(double x) {
+        if (count < 5) {
+            q[count++] = x;
+            if (count == 5) { std::sort(q, q + 5); }
+            return;
+        }
+        count++;
+        int k;
+        if (x < q[0]) {
+            q[0] = x;
+            k = 0;
+        } else if (x >= q[4]) {
+            q[4] = x;
+            k = 3;
+        } else {
+            k = 0;
+            while (x >= q[k + 1]) { k++; }
+        }
+        for (int i = k + 1; i < 5; i++) { n[i] += 1; }
+        for (int i = 0; i < 5; i++) { target[i] += increment[i]; }
+        for (int i = 1; i < 4; i++) {
+            double d = target[i] - n[i];
+            if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1)) {
+                int s = d > 0 ? 1 : -1;
+                double candidate = parabolic(i, s);
+                q[i] = (q[i - 1] < candidate && candidate < q[i + 1]) ? candidate : linear(i, s);
+                n[i] += s;
+            }
+        }
+    }
+
+    double estimate() const {
+        if (count >= 5) { return q[2]; }
+        assert(count > 0);
+        std::vector<double> first(q, q + count);
+        std::sort(first.begin(), first.end());
+        return first[size_t(p * (count - 1) + 0.5)];
+    }
+};
+
+// Consecutive batches of equal size; when max_batches is reached, adjacent batches are merged
+// pairwise and the batch size doubles. Memory stays O(max_batches) whatever the chain length.
+class BatchMeans {
+    std::vector<RunningStats> _batches;  // completed batches (all of size _batch_size)
+    RunningStats _current;               // batch being filled
+    size_t _batch_size{1};
+    size_t _max_batches;
+
+    void collapse() {
+        for (size_t i = 0; i < _max_batches / 2; i++) {
+            _batches[i] = _batches[2 * i];
+            _batches[i].merge(_batches[2 * i + 1]);
+        }
+        _batches.resize(_max_batches / 2);
+        _batch_size *= 2;
+    }
+
+  public:
+    BatchMeans(size_t max_batches = 64) : _max_batches(max_batches) {
+        assert(max_batches >= 4 && max_batches % 2 == 0);
+        _batches.reserve(max_batches);
+    }
+
+    void add(double x) {
+        _current.add(x);
+        if (_current.count == _batch_size) {
+            _batches.push_back(_current);
+            _current = RunningStats();
+            if (_batches.size() == _max_batches) { collapse(); }
+        }
+    }
+
+    size_t batch_size() const { return _batch_size; }
+    const std::vector<RunningStats>& batches() const { return _batches; }
+
+    // first and second halves of the chain (the partial batch goes to the second half)
+    RunningStats first_half() const {
+        RunningStats result;
+        for (size_t i = 0; i < _batches.size() / 2; i++) { result.merge(_batches[i]); }
+        return result;
+    }
+
+    RunningStats second_half() const {
+        RunningStats result;
+        for (size_t i = _batches.size() / 2; i < _batches.size(); i++) {
+            result.merge(_batches[i]);
+        }
+        result.merge(_current);
+        return result;
+    }
+
+    RunningStats total() const {
+        RunningStats result = first_half();
+        result.merge(second_half());
+        return result;
+    }
+};
+
+/*==================================================================================================
+~~ Multi-chain diagnostics ~~
+==================================================================================================*/
+
+// split-R-hat: each chain is cut in two halves and the potential scale reduction factor is
+// computed on the 2*K resulting sub-chains
+double split_rhat(const std::vector<const BatchMeans*>& chains) {
+    RunningStats means, within;
+    double length = 0;
+    for (auto c : chains) {
+        for (auto half : {c->first_half(), c->second_half()}) {
+            means.add(half.mean);
+            within.add(half.variance());
+            length += half.count;
+        }
+    }
+    length /= means.count;
+    double W = within.mean;
+    if (length < 2) { return 1.; }
+    if (W == 0) { return means.variance() == 0 ? 1. : INFINITY; }  // stuck chains
+    double var_plus = (length - 1) / length * W + means.variance();
+    return std::sqrt(var_plus / W);
+}
+
+// ESS from batch means: the asymptotic variance is estimated from the dispersion of all batch
+// means around the grand mean, which also penalizes chains that disagree with each other
+double batch_means_ess(const std::vector<const BatchMeans*>& chains) {
+    RunningStats all;
+    for (auto c : chains) { all.merge(c->total()); }
+    size_t batch_size = chains.front()->batch_size();
+    double ss = 0;
+    size_t nb_batches = 0;
+    for (auto c : chains) {
+        assert(c->batch_size() == batch_size);  // chains are expected to run in lockstep
+        for (auto& b : c->batches()) {
+            ss += (b.mean - all.mean) * (b.mean - all.mean);
+            nb_batches++;
+        }
+    }
+    if (nb_batches < 2) { return 0.; }
+    double asymptotic_variance = batch_size * ss / (nb_batches - 1);
+    if (asymptotic_variance == 0) { return 0.; }  // constant draws carry no information
+    return std::min(all.count, all.count * all.variance() / asymptotic_variance);
+}
+
+struct ConvergenceDiagnostics {
+    double mean;
+    double variance;
+    double rhat;
+    double ess_bulk;
+    double ess_tail;
+};
+
+// Streaming monitor for one scalar observable of one chain.
+// Bulk ESS is computed on the raw draws (rank-normalization would require the full traces).
+// Tail ESS is the ESS of the indicators of the 5% and 95% tails; tail thresholds are estimated
+// online with P-square estimators then frozen (see ConvergenceMonitor::set_tail_thresholds).
+struct ScalarMonitor {
+    BatchMeans values, below, above;
+    P2Quantile low{0.05}, high{0.95};
+    double low_threshold{0}, high_threshold{0};
+    bool thresholds_set{false};
+
+    void add(double x) {
+        values.add(x);
+        if (thresholds_set) {
+            below.add(x <= low_threshold);
+            above.add(x >= high_threshold);
+        } else {
+            low.add(x);
+            high.add(x);
+        }
+    }
+};
+
+// Monitors several scalar observables across several chains. Each chain only touches its own
+// monitors in add, so chains can report concurrently from their own thread.
+class ConvergenceMonitor {
+    std::vector<std::vector<ScalarMonitor>> _chains;
+
+  public:
+    ConvergenceMonitor(size_t nb_chains) : _chains(nb_chains) {}
+
+    template <class Observations>
+    void add(size_t chain, const Observations& obs) {
+        auto& monitors = _chains[chain];
+        if (monitors.empty()) { monitors.resize(obs.size()); }
+        assert(monitors.size() == obs.size());
+        for (size_t i = 0; i < monitors.size(); i++) { monitors[i].add(obs[i]); }
+    }
+
+    bool tail_thresholds_set() const {
+        return !_chains.front().empty() && _chains.front().front().thresholds_set;
+    }
+
+    // pools the per-chain quantile estimates and freezes them as tail thresholds
+    void set_tail_thresholds() {
+        for (size_t i = 0; i < _chains.front().size(); i++) {
+            double low = 0, high = 0;
+            for (auto& c : _chains) {
+                low += c[i].low.estimate();
+                high += c[i].high.estimate();
+            }
+            for (auto& c : _chains) {
+                c[i].low_threshold = low / _chains.size();
+                c[i].high_threshold = high / _chains.size();
+                c[i].thresholds_set = true;
+            }
+        }
+    }
+
+    std::vector<ConvergenceDiagnostics> diagnostics() const {
+        std::vector<ConvergenceDiagnostics> result;
+        for (size_t i = 0; i < _chains.front().size(); i++) {
+            std::vector<const BatchMeans *> values, below, above;
+            RunningStats all;
+            for (auto& c : _chains) {
+                values.push_back(&c[i].values);
+                below.push_back(&c[i].below);
+                above.push_back(&c[i].above);
+                all.merge(c[i].values.total());
+            }
+            double ess_tail = _chains.front()[i].thresholds_set
+                                  ? std::min(batch_means_ess(below), batch_means_ess(above))
+                                  : 0.;
+            result.push_back(
+                {all.mean, all.variance(), split_rhat(values), batch_means_ess(values), ess_tail});
+        }
+        return result;
+    }
+};
@@ -0,0 +1,305 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <limits>
+#include <random>
+#include <vector>
+
+/*==================================================================================================
+~~ Random engines ~~
+Drop-in replacements for std::mt19937 (they model UniformRandomBitGenerator, so they work with
+all std distributions and with every Gen& in the library), with small states and fast seeding.
+  - jump() moves an engine far ahead in its sequence (at least 2^64 draws)
+  - split() returns an engine for a new independent stream and moves this one past it, so
+    that streams derived from a master engine (see make_streams) are reproducible
+==================================================================================================*/
+namespace engine_utils {
+    // used to expand a 64-bit seed into engine states
+    uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+}  // namespace engine_utils
+
+// xoshiro256++ (Blackman & Vigna), 256-bit state; split() is jump-based (streams are disjoint
+// segments of length 2^128)
+class xoshiro256pp {
+    std::array<uint64_t, 4> s;
+
+    void apply_jump(const std::array<uint64_t, 4>& poly) {
+        std::array<uint64_t, 4> t{{0, 0, 0, 0}};
+        for (auto word : poly) {
+            for (int b = 0; b < 64; b++) {
+                if (word & (uint64_t(1) << b)) {
+                    for (size_t i = 0; i < 4; i++) { t[i] ^= s[i]; }
+                }
+                (*this)();
+            }
+        }
+        s = t;
+    }
+
+  public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit xoshiro256pp(uint64_t seed = 0) {
+        for (auto& word : s) { word = engine_utils::splitmix64(seed); }
+    }
+
+    result_type operator()() {
+        uint64_t result = engine_utils::rotl(s[0] + s[3], 23) + s[0];
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = engine_utils::rotl(s[3], 45);
+        return result;
+    }
+
+    // equivalent to 2^128 calls
+    void jump() {
+        apply_jump({{0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa,
+                     0x39abdc4529b1661c}});
+    }
+
+    // equivalent to 2^192 calls
+    void long_jump() {
+        apply_jump({{0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241,
+                     0x39109bb02acbe635}});
+    }
+
+    xoshiro256pp split() {
+        xoshiro256pp child = *this;
+        jump();
+        return child;
+    }
+};
+
+// PCG64 (O'Neill), 128-bit LCG with XSL-RR output; split() gives the child its own stream
+// (increment), so splits can be nested
+class pcg64 {
+    __extension__ typedef unsigned __int128 uint128;
+
+    uint128 state, inc;
+
+    static constexpr uint128 multiplier() {
+        return (uint128(0x2360ed051fc65da4) << 64) | 0x4385df649fccf645;
+    }
+
+    pcg64(uint128 initstate, uint128 initseq) : state(0), inc((initseq << 1) | 1) {
+        step();
+        state += initstate;
+        step();
+    }
+
+    void step() { state = state * multiplier() + inc; }
+
+  public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit pcg64(uint64_t seed = 0) : pcg64(seed, 0xda3e39cb94b95bdb) {}
+
+    result_type operator()() {
+        step();
+        uint64_t xored = uint64_t(state >> 64) ^ uint64_t(state);
+        int rot = int(state >> 122);
+        return (xored >> rot) | (xored << ((-rot) & 63));
+    }
+
+    // advances the generator by delta steps in O(log delta) (Brown, 1994)
+    void advance(uint128 delta) {
+        uint128 cur_mult = multiplier(), cur_plus = inc, acc_mult = 1, acc_plus = 0;
+        while (delta > 0) {
+            if (delta & 1) {
+                acc_mult *= cur_mult;
+                acc_plus = acc_plus * cur_mult + cur_plus;
+            }
+            cur_plus = (cur_mult + 1) * cur_plus;
+            cur_mult *= cur_mult;
+            delta >>= 1;
+        }
+        state = acc_mult * state + acc_plus;
+    }
+
+    // equivalent to 2^64 calls
+    void jump() { advance(uint128(1) << 64); }
+
+    pcg64 split() {
+        uint128 initstate = (uint128((*this)()) << 64) | (*this)();
+        uint128 initseq = (uint128((*this)()) << 64) | (*this)();
+        return pcg64(initstate, initseq);
+    }
+};
+
+// Philox4x32-10 (Salmon et al.), counter-based: the output is a bijective function of a 128-bit
+// counter under a 64-bit key, so a stream needs no state beyond (key, counter). split() gives the
+// child its own key, so splits can be nested.
+class philox4x32 {
+    std::array<uint32_t, 4> counter{{0, 0, 0, 0}};
+    std::array<uint32_t, 2> key;
+    std::array<uint32_t, 4> block;
+    int next_in_block{4};  // block is consumed as two 64-bit words
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+        uint64_t product = uint64_t(a) * b;
+        hi = uint32_t(product >> 32);
+        lo = uint32_t(product);
+    }
+
+    void increment_counter() {
+        for (auto& word : counter) {
+            if (++word != 0) { break; }
+        }
+    }
+
+  public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit philox4x32(uint64_t seed = 0) {
+        uint64_t k = engine_utils::splitmix64(seed);
+        key = {{uint32_t(k), uint32_t(k >> 32)}};
+    }
+
+    philox4x32(std::array<uint32_t, 2> key, std::array<uint32_t, 4> counter)
+        : counter(counter), key(key) {}
+
+    // the 10-round bijection applied to the current counter
+    std::array<uint32_t, 4> generate_block() const {
+        std::array<uint32_t, 4> c = counter;
+        std::array<uint32_t, 2> k = key;
+        for (int round = 0; round < 10; round++) {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(0xd2511f53, c[0], hi0, lo0);
+            mulhilo(0xcd9e8d57, c[2], hi1, lo1);
+            c = {{hi1 ^ c[1] ^ k[0], lo1, hi0 ^ c[3] ^ k[1], lo0}};
+            k[0] += 0x9e3779b9;
+            k[1] += 0xbb67ae85;
+        }
+        return c;
+    }
+
+    result_type operator()() {
+        if (next_in_block == 4) {
+            block = generate_block();
+            increment_counter();
+            next_in_block = 0;
+        }
+        uint64_t result = (uint64_t(block[next_in_block + 1]) << 32) | block[next_in_block];
+        next_in_block += 2;
+        return result;
+    }
+
+    // equivalent to 2^65 calls (increments the upper half of the counter)
+    void jump() {
+        if (++counter[2] == 0) { ++counter[3]; }
+    }
+
+    philox4x32 split() {
+        uint64_t k = (*this)();
+        return philox4x32({{uint32_t(k), uint32_t(k >> 32)}}, {{0, 0, 0, 0}});
+    }
+};
+
+using default_engine = xoshiro256pp;
+
+template <class Engine>
+Engine make_generator(uint64_t seed) {
+    return Engine(seed);
+}
+
+template <class Engine>
+Engine make_generator() {
+    std::random_device rd;
+    return Engine((uint64_t(rd()) << 32) | rd());
+}
+
+// n reproducible independent streams (e.g., one per thread, chain or particle) from a seed
+template <class Engine = default_engine>
+std::vector<Engine> make_streams(size_t n, uint64_t seed) {
+    Engine master(seed);
+    std::vector<Engine> result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; i++) { result.push_back(master.split()); }
+    return result;
+}
+
+// uniform double in [0, 1) from the 53 high bits of a 64-bit draw
+double to_unit_double(uint64_t x) { return (x >> 11) * (1.0 / 9007199254740992.0); }
+
+/*==================================================================================================
+~~ Buffered uniforms ~~
+Draws uniform doubles in [0, 1) by blocks of BufferSize, for loops that consume many uniforms
+(e.g., batched samplers). The engine is owned by the buffer.
+==================================================================================================*/
+template <class Engine, size_t BufferSize = 256>
+class BufferedUniform {
+    Engine _engine;
+    std::array<double, BufferSize> _buffer;
+    size_t _next{BufferSize};
+
+    void refill() {
+        for (auto& u : _buffer) { u = to_unit_double(_engine()); }
+        _next = 0;
+    }
+
+  public:
+    explicit BufferedUniform(Engine engine) : _engine(engine) {}
+
+    double operator()() {
+        if (_next == BufferSize) { refill(); }
+        return _buffer[_next++];
+    }
+
+    // fills [begin, end) with uniforms: empties the buffer, then draws the rest directly
+    void fill(double* begin, double* end) {
+        while (begin != end && _next != BufferSize) { *begin++ = _buffer[_next++]; }
+        for (; begin != end; begin++) { *begin = to_unit_double(_engine()); }
+    }
+
+    Engine& engine() { return _engine; }
+};
+
+template <class Engine>
+BufferedUniform<Engine> make_buffered_uniform(Engine engine) {
+    return BufferedUniform<Engine>(engine);
+}
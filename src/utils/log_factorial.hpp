@@ -0,0 +1,83 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "utils/math_utils.hpp"
+
+/*==================================================================================================
+~~ Log-factorials ~~
+log(n!) is read from a table that grows on demand up to log_factorial_table_max entries; larger
+arguments use the Stirling series, which is accurate to double precision there. The table is per
+thread, so lookups need no synchronization.
+==================================================================================================*/
+constexpr size_t log_factorial_table_max = 1 << 14;
+
+// Stirling series for lgamma(x), for large x
+double stirling_lgamma(double x) {
+    double inv_x = 1. / x, inv_x2 = inv_x * inv_x;
+    return (x - 0.5) * log(x) - x + 0.5 * log(2 * constants::pi) +
+           inv_x * (1. / 12 - inv_x2 * (1. / 360 - inv_x2 / 1260));
+}
+
+std::vector<double>& log_factorial_table(size_t n) {
+    static thread_local std::vector<double> table;
+    if (n >= table.size()) {
+        size_t old_size = table.size();
+        size_t new_size = std::max(size_t(64), old_size);
+        while (new_size <= n) { new_size *= 2; }
+        table.resize(std::min(new_size, log_factorial_table_max));
+        for (size_t k = old_size; k < table.size(); k++) { table[k] = std::lgamma(k + 1.); }
+    }
+    return table;
+}
+
+double log_factorial(size_t n) {
+    if (n >= log_factorial_table_max) { return stirling_lgamma(n + 1.); }
+    return log_factorial_table(n)[n];
+}
+
+// lgamma, through the log-factorial table when x is a positive integer (small enough to convert
+// to size_t)
+double log_gamma(double x) {
+    if (x >= 1 && x < 1e15 && x == floor(x)) { return log_factorial(size_t(x) - 1); }
+    return std::lgamma(x);
+}
+
+// log(a (a+1) ... (a+n-1)) = lgamma(a + n) - lgamma(a); when n is a small integer this is a
+// product, and no lgamma is needed
+double log_rising_factorial(double a, double n) {
+    if (n == floor(n) && n >= 0 && n <= 16 && a > 0 && a < 1e16) {
+        double prod = 1;
+        for (int k = 0; k < int(n); k++) { prod *= a + k; }
+        return log(prod);
+    }
+    return log_gamma(a + n) - log_gamma(a);
+}
@@ -0,0 +1,219 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*==================================================================================================
+~~ Memory-mapped datasets ~~
+Binary files made of a 64-byte header (magic, element type, shape) followed by the elements in
+row-major order. map_array<T>(path) and map_matrix<T>(path) map such files read-only: data is paged
+in on demand and shared through the page cache between processes. The returned views can be used as
+observed data (see make_observed_node_array), e.g.:
+    write_mapped_matrix("K.bin", counts);
+    auto K = make_observed_node_matrix<poisson>(map_matrix<pos_integer>("K.bin"), mn_to_m(lambda));
+==================================================================================================*/
+
+// element type code: kind ('f'loat, 'i'nt or 'u'nsigned) and size in bytes
+template <class T>
+constexpr uint32_t mapped_dtype() {
+    return (std::is_floating_point<T>::value ? 'f' : std::is_signed<T>::value ? 'i' : 'u') * 256 +
+           sizeof(T);
+}
+
+struct mapped_header {
+    char magic[8];
+    uint32_t dtype;
+    uint32_t nb_dims;
+    uint64_t shape[3];
+    char padding[64 - 8 - 2 * 4 - 3 * 8];
+};
+static_assert(sizeof(mapped_header) == 64, "mapped_header should be 64 bytes long");
+
+constexpr char mapped_magic[8] = {'B', 'T', 'M', 'A', 'P', '0', '0', '1'};
+
+template <class T>
+void write_mapped_file(const std::string& path, const T* data, std::vector<uint64_t> shape) {
+    assert(shape.size() > 0 and shape.size() <= 3);
+    mapped_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, mapped_magic, sizeof(mapped_magic));
+    header.dtype = mapped_dtype<T>();
+    header.nb_dims = shape.size();
+    uint64_t size = 1;
+    for (size_t i = 0; i < shape.size(); i++) {
+        header.shape[i] = shape[i];
+        size *= shape[i];
+    }
+    std::ofstream os(path, std::ios::binary);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(data), size * sizeof(T));
+    if (!os) { throw std::runtime_error("write_mapped_file: could not write " + path); }
+}
+
+template <class T>
+void write_mapped_array(const std::string& path, const std::vector<T>& values) {
+    write_mapped_file(path, values.data(), {values.size()});
+}
+
+template <class T>
+void write_mapped_matrix(const std::string& path, const std::vector<std::vector<T>>& values) {
+    size_t nb_cols = values.empty() ? 0 : values[0].size();
+    std::vector<T> flat;
+    flat.reserve(values.size() * nb_cols);
+    for (auto& row : values) {
+        assert(row.size() == nb_cols);
+        flat.insert(flat.end(), row.begin(), row.end());
+    }
+    write_mapped_file(path, flat.data(), {values.size(), nb_cols});
+}
+
+// read-only mapping of a whole file, unmapped on destruction
+class MappedFile {
+    void* _address{nullptr};
+    size_t _length{0};
+
+  public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) { throw std::runtime_error("MappedFile: could not open " + path); }
+        struct stat st;
+        if (fstat(fd, &st) != 0 or size_t(st.st_size) < sizeof(mapped_header)) {
+            close(fd);
+            throw std::runtime_error("MappedFile: " + path + " is not a mapped dataset");
+        }
+        _length = st.st_size;
+        _address = mmap(nullptr, _length, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (_address == MAP_FAILED) {
+            throw std::runtime_error("MappedFile: could not map " + path);
+        }
+        if (std::memcmp(header().magic, mapped_magic, sizeof(mapped_magic)) != 0) {
+            munmap(_address, _length);
+            throw std::runtime_error("MappedFile: " + path + " is not a mapped dataset");
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { munmap(_address, _length); }
+
+    const mapped_header& header() const { return *static_cast<const mapped_header*>(_address); }
+
+    // checks element type and number of dimensions
+    template <class T>
+    const T* data(uint32_t nb_dims) const {
+        if (header().dtype != mapped_dtype<T>() or header().nb_dims != nb_dims) {
+            throw std::runtime_error("MappedFile: wrong element type or number of dimensions");
+        }
+        uint64_t size = 1;
+        for (uint32_t i = 0; i < nb_dims; i++) { size *= header().shape[i]; }
+        if (sizeof(mapped_header) + size * sizeof(T) > _length) {
+            throw std::runtime_error("MappedFile: truncated file");
+        }
+        return reinterpret_cast<const T*>(static_cast<const char*>(_address) +
+                                          sizeof(mapped_header));
+    }
+};
+
+// contiguous read-only range, with the part of the std::vector interface used on node values
+template <class T>
+class MappedRow {
+    const T* _data;
+    size_t _size;
+
+  public:
+    MappedRow(const T* data, size_t size) : _data(data), _size(size) {}
+
+    const T& operator[](size_t i) const { return _data[i]; }
+    const T& at(size_t i) const {
+        assert(i < _size);
+        return _data[i];
+    }
+    size_t size() const { return _size; }
+    const T* data() const { return _data; }
+    const T* begin() const { return _data; }
+    const T* end() const { return _data + _size; }
+};
+
+template <class T>
+class MappedArray : public MappedRow<T> {
+    std::unique_ptr<MappedFile> _file;
+
+    MappedArray(std::unique_ptr<MappedFile> file)
+        : MappedRow<T>(file->data<T>(1), file->header().shape[0]), _file(std::move(file)) {}
+
+  public:
+    explicit MappedArray(const std::string& path)
+        : MappedArray(std::make_unique<MappedFile>(path)) {}
+};
+
+template <class T>
+class MappedMatrix {
+    std::unique_ptr<MappedFile> _file;
+    const T* _data;
+    size_t _nb_rows, _nb_cols;
+
+  public:
+    explicit MappedMatrix(const std::string& path)
+        : _file(std::make_unique<MappedFile>(path)),
+          _data(_file->data<T>(2)),
+          _nb_rows(_file->header().shape[0]),
+          _nb_cols(_file->header().shape[1]) {}
+
+    MappedRow<T> operator[](size_t i) const { return {_data + i * _nb_cols, _nb_cols}; }
+    MappedRow<T> at(size_t i) const {
+        assert(i < _nb_rows);
+        return (*this)[i];
+    }
+    size_t size() const { return _nb_rows; }
+    const T* data() const { return _data; }
+};
+
+template <class T>
+auto map_array(const std::string& path) {
+    return std::shared_ptr<const MappedArray<T>>(std::make_shared<MappedArray<T>>(path));
+}
+
+template <class T>
+auto map_matrix(const std::string& path) {
+    return std::shared_ptr<const MappedMatrix<T>>(std::make_shared<MappedMatrix<T>>(path));
+}
@@ -0,0 +1,51 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+size_t default_nb_threads() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+// calls f(i) for i in [0, n), split in contiguous chunks across nb_threads threads
+template <class F>
+void parallel_for(size_t n, size_t nb_threads, F f) {
+    nb_threads = std::min(nb_threads, n);
+    if (nb_threads <= 1) {
+        for (size_t i = 0; i < n; i++) { f(i); }
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nb_threads; t++) {
+        threads.emplace_back([&f, n, t, nb_threads]() {
+            for (size_t i = t * n / nb_threads; i < (t + 1) * n / nb_threads; i++) { f(i); }
+        });
+    }
+    for (auto& t : threads) { t.join(); }
+}
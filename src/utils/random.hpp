@@ -29,6 +29,8 @@ license and that you accept its terms.*/
 #include <assert.h>
 #include <float.h>
 #include <random>
+#include <vector>
+#include "utils/engines.hpp"
 
 std::mt19937 make_generator(int seed) { return std::mt19937(seed); }
 
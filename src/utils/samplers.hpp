@@ -0,0 +1,157 @@
+/*Copyright or © or Copr. CNRS (2019). Contributors:
+- Vincent Lanore. vincent.lanore@gmail.com
+
+This software is a computer program whose purpose is to provide a set of C++ data structures and
+functions to perform Bayesian inference with MCMC algorithms.
+
+This software is governed by the CeCILL-C license under French law and abiding by the rules of
+distribution of free software. You can use, modify and/ or redistribute the software under the terms
+of the CeCILL-C license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info".
+
+As a counterpart to the access to the source code and rights to copy, modify and redistribute
+granted by the license, users are provided only with a limited warranty and the software's author,
+the holder of the economic rights, and the successive licensors have only limited liability.
+
+In this respect, the user's attention is drawn to the risks associated with loading, using,
+modifying and/or developing or reproducing the software by the user in light of its specific status
+of free software, that may mean that it is complicated to manipulate, and that also therefore means
+that it is reserved for developers and experienced professionals having in-depth computer knowledge.
+Users are therefore encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or data to be ensured and,
+more generally, to use and operate it in the same conditions as regards security.
+
+The fact that you are presently reading this means that you have had knowledge of the CeCILL-C
+license and that you accept its terms.*/
+
+
+#pragma once
+
+#include <cmath>
+#include <random>
+#include "utils/log_factorial.hpp"
+
+/*==================================================================================================
+~~ Samplers ~~
+In-house samplers used by the distributions instead of std::*_distribution objects. Samplers
+that need a setup step (gamma, poisson) are objects built from their parameters, so that batched
+draws (array_draw) only redo the setup when the parameters change.
+==================================================================================================*/
+
+// uniform in [0, 1)
+template <class Gen>
+double draw_unit(Gen& gen) {
+    return std::generate_canonical<double, 53>(gen);
+}
+
+// standard normal, Marsaglia polar method (the second value is dropped to keep samplers
+// stateless)
+template <class Gen>
+double draw_std_normal(Gen& gen) {
+    double u, v, s;
+    do {
+        u = 2 * draw_unit(gen) - 1;
+        v = 2 * draw_unit(gen) - 1;
+        s = u * u + v * v;
+    } while (s >= 1 || s == 0);
+    return u * sqrt(-2 * log(s) / s);
+}
+
+template <class Gen>
+int draw_bernoulli(double p, Gen& gen) {
+    return draw_unit(gen) < p;
+}
+
+// Gamma(shape, 1): Marsaglia & Tsang (2000); shapes below 1 are boosted to shape + 1 and
+// corrected by u^(1/shape)
+class GammaSampler {
+    double _shape, _d, _c;
+
+  public:
+    explicit GammaSampler(double shape)
+        : _shape(shape), _d((shape < 1 ? shape + 1 : shape) - 1. / 3), _c(1. / sqrt(9 * _d)) {}
+
+    double shape() const { return _shape; }
+
+    template <class Gen>
+    double operator()(Gen& gen) const {
+        double result;
+        while (true) {
+            double x, v;
+            do {
+                x = draw_std_normal(gen);
+                v = 1 + _c * x;
+            } while (v <= 0);
+            v = v * v * v;
+            double u = draw_unit(gen);
+            if (u < 1 - 0.0331 * x * x * x * x ||
+                log(u) < 0.5 * x * x + _d * (1 - v + log(v))) {
+                result = _d * v;
+                break;
+            }
+        }
+        if (_shape < 1) { result *= pow(1 - draw_unit(gen), 1 / _shape); }
+        return result;
+    }
+};
+
+// Poisson(rate): multiplication method for small rates, PTRS (Hormann, 1993) otherwise
+class PoissonSampler {
+    double _rate, _exp_minus_rate;
+    double _log_rate, _a, _b, _log_inv_alpha, _vr;  // PTRS constants
+
+  public:
+    explicit PoissonSampler(double rate) : _rate(rate), _exp_minus_rate(exp(-rate)) {
+        double sqrt_rate = sqrt(rate);
+        _log_rate = log(rate);
+        _b = 0.931 + 2.53 * sqrt_rate;
+        _a = -0.059 + 0.02483 * _b;
+        _log_inv_alpha = log(1.1239 + 1.1328 / (_b - 3.4));
+        _vr = 0.9277 - 3.6224 / (_b - 2);
+    }
+
+    double rate() const { return _rate; }
+
+    template <class Gen>
+    int operator()(Gen& gen) const {
+        if (_rate < 10) {
+            int k = 0;
+            double prod = draw_unit(gen);
+            while (prod > _exp_minus_rate) {
+                k++;
+                prod *= draw_unit(gen);
+            }
+            return k;
+        }
+        while (true) {
+            double u = draw_unit(gen) - 0.5;
+            double v = draw_unit(gen);
+            double us = 0.5 - std::abs(u);
+            double k = floor((2 * _a / us + _b) * u + _rate + 0.43);
+            if (us >= 0.07 && v <= _vr) { return int(k); }
+            if (k < 0 || (us < 0.013 && v > us)) { continue; }
+            if (log(v) + _log_inv_alpha - log(_a / (us * us) + _b) <=
+                -_rate + k * _log_rate - log_factorial(size_t(k))) {
+                return int(k);
+            }
+        }
+    }
+};
+
+// Beta(a, b) as a ratio of gammas
+class BetaSampler {
+    GammaSampler _ga, _gb;
+
+  public:
+    BetaSampler(double a, double b) : _ga(a), _gb(b) {}
+
+    double weight_a() const { return _ga.shape(); }
+    double weight_b() const { return _gb.shape(); }
+
+    template <class Gen>
+    double operator()(Gen& gen) const {
+        double a = _ga(gen);
+        double b = _gb(gen);
+        return a / (a + b);
+    }
+};